@@ -0,0 +1,28 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class CausticsReferenceTarget : TargetRules
+{
+	public CausticsReferenceTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		LaunchModuleName = "CausticsReference";
+
+		// Lean and mean
+		bBuildDeveloperTools = false;
+		bUseMallocProfiler = false;
+		bBuildWithEditorOnlyData = false;
+
+		// Headless tool: only Core is needed, so compile out references from Core to the rest of the engine
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = false;
+
+		// Runs on build machines, so it is a console application (sets entry point to main(), instead of WinMain())
+		bIsBuildingConsoleApplication = true;
+	}
+}
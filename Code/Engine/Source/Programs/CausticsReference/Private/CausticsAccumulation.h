@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/////////////////////////////////////////////////////////////////////////////////
+// CPU counterparts of RayTracingCausticsAccumulation.ush and RayTracingCausticsResolve.usf.
+// The caustics color is accumulated as four signed fixed point channels per pixel,
+// stored as two's complement in uint32 so that the sum does not depend on the order of the splats.
+/////////////////////////////////////////////////////////////////////////////////
+
+/** Mirrors CAUSTICS_ACCUMULATION_MAX_ENCODED_VALUE: the clamp of a single contribution, so that 255 of them fit in a channel. */
+static const float CausticsAccumulationMaxEncodedValue = 8388608.0f;
+
+/** Mirrors CAUSTICS_ACCUMULATION_CHANNELS. */
+static const int32 CausticsAccumulationChannels = 4;
+
+/** Default of r.RayTracing.Caustics.AccumulationScale. */
+static const float DefaultCausticsAccumulationScale = 1024.0f;
+
+FORCEINLINE uint32 EncodeCausticsAccumulation(float Value, float Scale)
+{
+	const float Encoded = FMath::Clamp(Value * Scale, -CausticsAccumulationMaxEncodedValue, CausticsAccumulationMaxEncodedValue);
+	return uint32(int32(FMath::RoundHalfFromZero(Encoded)));
+}
+
+FORCEINLINE float DecodeCausticsAccumulation(uint32 Value, float Scale)
+{
+	return float(int32(Value)) / Scale;
+}
+
+FORCEINLINE int32 GetCausticsAccumulationIndex(FIntPoint ThreadId, FIntPoint Extent)
+{
+	return (ThreadId.Y * Extent.X + ThreadId.X) * CausticsAccumulationChannels;
+}
+
+/** AccumulateCausticsColor(): adds Color to the pixel, dropping writes outside of the buffer. */
+FORCEINLINE void AccumulateCausticsColor(TArray<uint32>& Accumulation, FIntPoint Extent, float Scale, FIntPoint ThreadId, const FLinearColor& Color)
+{
+	if (ThreadId.X >= 0 && ThreadId.Y >= 0 && ThreadId.X < Extent.X && ThreadId.Y < Extent.Y)
+	{
+		const int32 Index = GetCausticsAccumulationIndex(ThreadId, Extent);
+		const float Channels[CausticsAccumulationChannels] = { Color.R, Color.G, Color.B, Color.A };
+		for (int32 Channel = 0; Channel < CausticsAccumulationChannels; ++Channel)
+		{
+			// Unsigned wrap around is the two's complement sum of the signed values
+			Accumulation[Index + Channel] += EncodeCausticsAccumulation(Channels[Channel], Scale);
+		}
+	}
+}
+
+/** RayTracingCausticsResolveCS: converts the whole accumulation buffer to the float4 color the denoiser reads. */
+FORCEINLINE void ResolveCausticsAccumulation(const TArray<uint32>& Accumulation, FIntPoint Extent, float Scale, TArray<FLinearColor>& OutColor)
+{
+	check(Accumulation.Num() == Extent.X * Extent.Y * CausticsAccumulationChannels);
+	OutColor.SetNumUninitialized(Extent.X * Extent.Y);
+	for (int32 PixelIndex = 0; PixelIndex < OutColor.Num(); ++PixelIndex)
+	{
+		const int32 Index = PixelIndex * CausticsAccumulationChannels;
+		OutColor[PixelIndex] = FLinearColor(
+			DecodeCausticsAccumulation(Accumulation[Index + 0], Scale),
+			DecodeCausticsAccumulation(Accumulation[Index + 1], Scale),
+			DecodeCausticsAccumulation(Accumulation[Index + 2], Scale),
+			DecodeCausticsAccumulation(Accumulation[Index + 3], Scale));
+	}
+}
@@ -0,0 +1,665 @@
+#include "CausticsBVH.h"
+#include "CausticsScene.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	const int32 NumSAHBins = 12;
+	const int32 MaxLeafTriangles = 4;
+
+	float SurfaceArea(const FVector& BoundsMin, const FVector& BoundsMax)
+	{
+		const FVector Extent = (BoundsMax - BoundsMin).ComponentMax(FVector::ZeroVector);
+		return 2.0f * (Extent.X * Extent.Y + Extent.Y * Extent.Z + Extent.Z * Extent.X);
+	}
+}
+
+void FCausticsBVH::Build(const FCausticsScene& Scene)
+{
+	const int32 NumSceneTriangles = Scene.NumTriangles();
+
+	Nodes.Reset();
+	if (NumSceneTriangles == 0)
+	{
+		return;
+	}
+
+	TArray<FVector> Centroids;
+	TArray<FVector> BoundsMin;
+	TArray<FVector> BoundsMax;
+	Centroids.SetNumUninitialized(NumSceneTriangles);
+	BoundsMin.SetNumUninitialized(NumSceneTriangles);
+	BoundsMax.SetNumUninitialized(NumSceneTriangles);
+
+	TriangleIndices.SetNumUninitialized(NumSceneTriangles);
+	for (int32 TriangleIndex = 0; TriangleIndex < NumSceneTriangles; ++TriangleIndex)
+	{
+		FVector V0, V1, V2;
+		Scene.GetTriangle(TriangleIndex, V0, V1, V2);
+		BoundsMin[TriangleIndex] = V0.ComponentMin(V1).ComponentMin(V2);
+		BoundsMax[TriangleIndex] = V0.ComponentMax(V1).ComponentMax(V2);
+		Centroids[TriangleIndex] = (BoundsMin[TriangleIndex] + BoundsMax[TriangleIndex]) * 0.5f;
+		TriangleIndices[TriangleIndex] = TriangleIndex;
+	}
+
+	TArray<FBinaryNode> BinaryNodes;
+	BinaryNodes.Reserve(FMath::Max(1, 2 * NumSceneTriangles / MaxLeafTriangles));
+	BuildBinaryRecursive(BinaryNodes, 0, NumSceneTriangles, Centroids, BoundsMin, BoundsMax);
+
+	// Store the triangles in leaf order so that a leaf reads a contiguous range
+	Triangles.SetNumUninitialized(NumSceneTriangles);
+	for (int32 LeafSlot = 0; LeafSlot < NumSceneTriangles; ++LeafSlot)
+	{
+		const int32 TriangleIndex = TriangleIndices[LeafSlot];
+		FVector V0, V1, V2;
+		Scene.GetTriangle(TriangleIndex, V0, V1, V2);
+
+		FTriangle& Triangle = Triangles[LeafSlot];
+		Triangle.V0 = V0;
+		Triangle.Edge1 = V1 - V0;
+		Triangle.Edge2 = V2 - V0;
+		Triangle.Mask = Scene.Instances[Scene.TriangleInstances[TriangleIndex]].Mask;
+	}
+
+	// Propagate instance masks bottom up. Children are always stored after their parent.
+	for (int32 NodeIndex = BinaryNodes.Num() - 1; NodeIndex >= 0; --NodeIndex)
+	{
+		FBinaryNode& Node = BinaryNodes[NodeIndex];
+		Node.Mask = 0;
+		if (Node.NumTriangles > 0)
+		{
+			for (int32 LeafSlot = Node.Offset; LeafSlot < Node.Offset + Node.NumTriangles; ++LeafSlot)
+			{
+				Node.Mask |= Triangles[LeafSlot].Mask;
+			}
+		}
+		else
+		{
+			Node.Mask = BinaryNodes[NodeIndex + 1].Mask | BinaryNodes[Node.Offset].Mask;
+		}
+	}
+
+	Nodes.Reset(BinaryNodes.Num() / 2 + 1);
+	CollapseRecursive(BinaryNodes, 0);
+}
+
+int32 FCausticsBVH::BuildBinaryRecursive(TArray<FBinaryNode>& BinaryNodes, int32 FirstTriangle, int32 NumTriangles, const TArray<FVector>& Centroids, const TArray<FVector>& BoundsMin, const TArray<FVector>& BoundsMax)
+{
+	const int32 NodeIndex = BinaryNodes.AddUninitialized();
+	{
+		FBinaryNode& Node = BinaryNodes[NodeIndex];
+		Node.BoundsMin = FVector(MAX_flt);
+		Node.BoundsMax = FVector(-MAX_flt);
+		Node.Offset = FirstTriangle;
+		Node.NumTriangles = NumTriangles;
+		Node.Mask = 0;
+	}
+
+	FVector NodeMin(MAX_flt);
+	FVector NodeMax(-MAX_flt);
+	FVector CentroidMin(MAX_flt);
+	FVector CentroidMax(-MAX_flt);
+	for (int32 Slot = FirstTriangle; Slot < FirstTriangle + NumTriangles; ++Slot)
+	{
+		const int32 TriangleIndex = TriangleIndices[Slot];
+		NodeMin = NodeMin.ComponentMin(BoundsMin[TriangleIndex]);
+		NodeMax = NodeMax.ComponentMax(BoundsMax[TriangleIndex]);
+		CentroidMin = CentroidMin.ComponentMin(Centroids[TriangleIndex]);
+		CentroidMax = CentroidMax.ComponentMax(Centroids[TriangleIndex]);
+	}
+	BinaryNodes[NodeIndex].BoundsMin = NodeMin;
+	BinaryNodes[NodeIndex].BoundsMax = NodeMax;
+
+	if (NumTriangles <= MaxLeafTriangles)
+	{
+		return NodeIndex;
+	}
+
+	const FVector CentroidExtent = CentroidMax - CentroidMin;
+	const int32 Axis = CentroidExtent.X >= CentroidExtent.Y && CentroidExtent.X >= CentroidExtent.Z ? 0 : (CentroidExtent.Y >= CentroidExtent.Z ? 1 : 2);
+	if (CentroidExtent[Axis] <= 0.0f)
+	{
+		// Every centroid is at the same place, no split can separate them.
+		return NodeIndex;
+	}
+
+	struct FBin
+	{
+		FVector BoundsMin = FVector(MAX_flt);
+		FVector BoundsMax = FVector(-MAX_flt);
+		int32 NumTriangles = 0;
+	};
+	FBin Bins[NumSAHBins];
+
+	const float BinScale = NumSAHBins / CentroidExtent[Axis];
+	auto GetBinIndex = [&](int32 TriangleIndex)
+	{
+		return FMath::Min(NumSAHBins - 1, int32((Centroids[TriangleIndex][Axis] - CentroidMin[Axis]) * BinScale));
+	};
+
+	for (int32 Slot = FirstTriangle; Slot < FirstTriangle + NumTriangles; ++Slot)
+	{
+		const int32 TriangleIndex = TriangleIndices[Slot];
+		FBin& Bin = Bins[GetBinIndex(TriangleIndex)];
+		Bin.BoundsMin = Bin.BoundsMin.ComponentMin(BoundsMin[TriangleIndex]);
+		Bin.BoundsMax = Bin.BoundsMax.ComponentMax(BoundsMax[TriangleIndex]);
+		Bin.NumTriangles++;
+	}
+
+	// Sweep from the right to get the cost of every right hand side, then from the left to pick the best split.
+	float RightCost[NumSAHBins];
+	{
+		FVector RightMin(MAX_flt);
+		FVector RightMax(-MAX_flt);
+		int32 RightCount = 0;
+		for (int32 BinIndex = NumSAHBins - 1; BinIndex > 0; --BinIndex)
+		{
+			RightMin = RightMin.ComponentMin(Bins[BinIndex].BoundsMin);
+			RightMax = RightMax.ComponentMax(Bins[BinIndex].BoundsMax);
+			RightCount += Bins[BinIndex].NumTriangles;
+			RightCost[BinIndex] = RightCount > 0 ? SurfaceArea(RightMin, RightMax) * RightCount : 0.0f;
+		}
+	}
+
+	int32 BestSplit = INDEX_NONE;
+	float BestCost = SurfaceArea(NodeMin, NodeMax) * NumTriangles;
+	{
+		FVector LeftMin(MAX_flt);
+		FVector LeftMax(-MAX_flt);
+		int32 LeftCount = 0;
+		for (int32 BinIndex = 0; BinIndex < NumSAHBins - 1; ++BinIndex)
+		{
+			LeftMin = LeftMin.ComponentMin(Bins[BinIndex].BoundsMin);
+			LeftMax = LeftMax.ComponentMax(Bins[BinIndex].BoundsMax);
+			LeftCount += Bins[BinIndex].NumTriangles;
+			if (LeftCount == 0 || LeftCount == NumTriangles)
+			{
+				continue;
+			}
+
+			const float Cost = SurfaceArea(LeftMin, LeftMax) * LeftCount + RightCost[BinIndex + 1];
+			if (Cost < BestCost)
+			{
+				BestCost = Cost;
+				BestSplit = BinIndex;
+			}
+		}
+	}
+
+	int32 NumLeft;
+	if (BestSplit != INDEX_NONE)
+	{
+		int32 Left = FirstTriangle;
+		int32 Right = FirstTriangle + NumTriangles - 1;
+		while (Left <= Right)
+		{
+			if (GetBinIndex(TriangleIndices[Left]) <= BestSplit)
+			{
+				++Left;
+			}
+			else
+			{
+				Swap(TriangleIndices[Left], TriangleIndices[Right--]);
+			}
+		}
+		NumLeft = Left - FirstTriangle;
+	}
+	else
+	{
+		// SAH prefers a leaf, but keep leaves small: fall back to a median split.
+		Sort(TriangleIndices.GetData() + FirstTriangle, NumTriangles, [&Centroids, Axis](int32 A, int32 B)
+		{
+			return Centroids[A][Axis] < Centroids[B][Axis];
+		});
+		NumLeft = NumTriangles / 2;
+	}
+
+	BuildBinaryRecursive(BinaryNodes, FirstTriangle, NumLeft, Centroids, BoundsMin, BoundsMax);
+	const int32 SecondChild = BuildBinaryRecursive(BinaryNodes, FirstTriangle + NumLeft, NumTriangles - NumLeft, Centroids, BoundsMin, BoundsMax);
+
+	BinaryNodes[NodeIndex].Offset = SecondChild;
+	BinaryNodes[NodeIndex].NumTriangles = 0;
+	return NodeIndex;
+}
+
+int32 FCausticsBVH::CollapseRecursive(const TArray<FBinaryNode>& BinaryNodes, int32 BinaryNodeIndex)
+{
+	// Open up to two levels of the binary tree, always splitting the largest interior candidate
+	int32 Candidates[4];
+	int32 NumCandidates = 0;
+	const FBinaryNode& BinaryNode = BinaryNodes[BinaryNodeIndex];
+	if (BinaryNode.NumTriangles > 0)
+	{
+		Candidates[NumCandidates++] = BinaryNodeIndex;
+	}
+	else
+	{
+		Candidates[NumCandidates++] = BinaryNodeIndex + 1;
+		Candidates[NumCandidates++] = BinaryNode.Offset;
+	}
+
+	while (NumCandidates < 4)
+	{
+		int32 BestCandidate = INDEX_NONE;
+		float BestArea = -1.0f;
+		for (int32 CandidateIndex = 0; CandidateIndex < NumCandidates; ++CandidateIndex)
+		{
+			const FBinaryNode& Candidate = BinaryNodes[Candidates[CandidateIndex]];
+			const float Area = SurfaceArea(Candidate.BoundsMin, Candidate.BoundsMax);
+			if (Candidate.NumTriangles == 0 && Area > BestArea)
+			{
+				BestArea = Area;
+				BestCandidate = CandidateIndex;
+			}
+		}
+
+		if (BestCandidate == INDEX_NONE)
+		{
+			break;
+		}
+
+		const int32 Opened = Candidates[BestCandidate];
+		Candidates[BestCandidate] = Opened + 1;
+		Candidates[NumCandidates++] = BinaryNodes[Opened].Offset;
+	}
+
+	const int32 NodeIndex = Nodes.AddUninitialized();
+	for (int32 Slot = 0; Slot < 4; ++Slot)
+	{
+		FNode& Node = Nodes[NodeIndex];
+		if (Slot >= NumCandidates)
+		{
+			// Inverted bounds never pass the slab test
+			Node.BoundsMinX[Slot] = Node.BoundsMinY[Slot] = Node.BoundsMinZ[Slot] = MAX_flt;
+			Node.BoundsMaxX[Slot] = Node.BoundsMaxY[Slot] = Node.BoundsMaxZ[Slot] = -MAX_flt;
+			Node.ChildIndex[Slot] = INDEX_NONE;
+			Node.ChildNumTriangles[Slot] = 0;
+			Node.ChildMask[Slot] = 0;
+			continue;
+		}
+
+		const FBinaryNode& Child = BinaryNodes[Candidates[Slot]];
+		Node.BoundsMinX[Slot] = Child.BoundsMin.X;
+		Node.BoundsMinY[Slot] = Child.BoundsMin.Y;
+		Node.BoundsMinZ[Slot] = Child.BoundsMin.Z;
+		Node.BoundsMaxX[Slot] = Child.BoundsMax.X;
+		Node.BoundsMaxY[Slot] = Child.BoundsMax.Y;
+		Node.BoundsMaxZ[Slot] = Child.BoundsMax.Z;
+		Node.ChildNumTriangles[Slot] = Child.NumTriangles;
+		Node.ChildMask[Slot] = Child.Mask;
+		Node.ChildIndex[Slot] = Child.NumTriangles > 0 ? Child.Offset : INDEX_NONE;
+	}
+
+	// Recurse once the node is complete, Nodes may be reallocated by the children
+	for (int32 Slot = 0; Slot < NumCandidates; ++Slot)
+	{
+		if (BinaryNodes[Candidates[Slot]].NumTriangles == 0)
+		{
+			const int32 ChildIndex = CollapseRecursive(BinaryNodes, Candidates[Slot]);
+			Nodes[NodeIndex].ChildIndex[Slot] = ChildIndex;
+		}
+	}
+	return NodeIndex;
+}
+
+namespace
+{
+	/** Ray data broadcast to every lane, for testing one ray against the four children of a node. */
+	struct FSingleRaySIMD
+	{
+		VectorRegister OriginX;
+		VectorRegister OriginY;
+		VectorRegister OriginZ;
+		VectorRegister InvDirectionX;
+		VectorRegister InvDirectionY;
+		VectorRegister InvDirectionZ;
+		VectorRegister TMin;
+	};
+
+	/** Slab test of one ray against four boxes stored SoA. Returns the lanes that are hit and their entry distance. */
+	FORCEINLINE int32 IntersectBoxes4(
+		const float* RESTRICT BoundsMinX, const float* RESTRICT BoundsMinY, const float* RESTRICT BoundsMinZ,
+		const float* RESTRICT BoundsMaxX, const float* RESTRICT BoundsMaxY, const float* RESTRICT BoundsMaxZ,
+		const FSingleRaySIMD& Ray, float ClosestT, VectorRegister& OutTNear)
+	{
+		const VectorRegister T0X = VectorMultiply(VectorSubtract(VectorLoadAligned(BoundsMinX), Ray.OriginX), Ray.InvDirectionX);
+		const VectorRegister T1X = VectorMultiply(VectorSubtract(VectorLoadAligned(BoundsMaxX), Ray.OriginX), Ray.InvDirectionX);
+		const VectorRegister T0Y = VectorMultiply(VectorSubtract(VectorLoadAligned(BoundsMinY), Ray.OriginY), Ray.InvDirectionY);
+		const VectorRegister T1Y = VectorMultiply(VectorSubtract(VectorLoadAligned(BoundsMaxY), Ray.OriginY), Ray.InvDirectionY);
+		const VectorRegister T0Z = VectorMultiply(VectorSubtract(VectorLoadAligned(BoundsMinZ), Ray.OriginZ), Ray.InvDirectionZ);
+		const VectorRegister T1Z = VectorMultiply(VectorSubtract(VectorLoadAligned(BoundsMaxZ), Ray.OriginZ), Ray.InvDirectionZ);
+
+		const VectorRegister TNear = VectorMax(VectorMax(VectorMin(T0X, T1X), VectorMin(T0Y, T1Y)), VectorMax(VectorMin(T0Z, T1Z), Ray.TMin));
+		const VectorRegister TFar = VectorMin(VectorMin(VectorMax(T0X, T1X), VectorMax(T0Y, T1Y)), VectorMin(VectorMax(T0Z, T1Z), VectorSetFloat1(ClosestT)));
+
+		OutTNear = TNear;
+		return VectorMaskBits(VectorCompareGE(TFar, TNear));
+	}
+
+	/** Packet rays stored SoA, one ray per lane. */
+	struct FRayPacketSIMD
+	{
+		VectorRegister OriginX;
+		VectorRegister OriginY;
+		VectorRegister OriginZ;
+		VectorRegister DirectionX;
+		VectorRegister DirectionY;
+		VectorRegister DirectionZ;
+		VectorRegister InvDirectionX;
+		VectorRegister InvDirectionY;
+		VectorRegister InvDirectionZ;
+		VectorRegister TMin;
+	};
+
+	struct FTraversalEntry
+	{
+		int32 Index;
+		int32 NumTriangles;
+		float TNear;
+		int32 LaneMask;
+	};
+
+	/** Stack deep enough for four-wide trees well beyond the triangle counts we load. */
+	const int32 MaxTraversalStackSize = 128;
+}
+
+bool FCausticsBVH::TraceRay(const FCausticsRay& Ray, uint32 RayFlags, uint32 InstanceInclusionMask, FCausticsHit& OutHit) const
+{
+	OutHit = FCausticsHit();
+	if (Nodes.Num() == 0)
+	{
+		return false;
+	}
+
+	const bool bCullBackFaces = (RayFlags & ECausticsRayFlags::CullBackFacingTriangles) != 0;
+	const bool bAcceptFirstHit = (RayFlags & ECausticsRayFlags::AcceptFirstHitAndEndSearch) != 0;
+
+	FSingleRaySIMD RaySIMD;
+	RaySIMD.OriginX = VectorSetFloat1(Ray.Origin.X);
+	RaySIMD.OriginY = VectorSetFloat1(Ray.Origin.Y);
+	RaySIMD.OriginZ = VectorSetFloat1(Ray.Origin.Z);
+	RaySIMD.InvDirectionX = VectorSetFloat1(1.0f / Ray.Direction.X);
+	RaySIMD.InvDirectionY = VectorSetFloat1(1.0f / Ray.Direction.Y);
+	RaySIMD.InvDirectionZ = VectorSetFloat1(1.0f / Ray.Direction.Z);
+	RaySIMD.TMin = VectorSetFloat1(Ray.TMin);
+	float ClosestT = Ray.TMax;
+
+	FTraversalEntry Stack[MaxTraversalStackSize];
+	int32 StackSize = 0;
+	Stack[StackSize++] = { 0, 0, Ray.TMin, 1 };
+
+	while (StackSize > 0)
+	{
+		const FTraversalEntry Entry = Stack[--StackSize];
+		if (Entry.TNear > ClosestT)
+		{
+			continue;
+		}
+
+		if (Entry.NumTriangles == 0)
+		{
+			const FNode& Node = Nodes[Entry.Index];
+
+			VectorRegister TNearRegister;
+			int32 HitMask = IntersectBoxes4(Node.BoundsMinX, Node.BoundsMinY, Node.BoundsMinZ, Node.BoundsMaxX, Node.BoundsMaxY, Node.BoundsMaxZ, RaySIMD, ClosestT, TNearRegister);
+
+			MS_ALIGN(16) float TNear[4] GCC_ALIGN(16);
+			VectorStoreAligned(TNearRegister, TNear);
+
+			// Push the hit children far to near so that the nearest one is visited next
+			const int32 FirstPushed = StackSize;
+			for (int32 Slot = 0; Slot < 4; ++Slot)
+			{
+				if ((HitMask & (1 << Slot)) == 0 || (Node.ChildMask[Slot] & InstanceInclusionMask) == 0)
+				{
+					continue;
+				}
+
+				check(StackSize < MaxTraversalStackSize);
+				int32 InsertAt = StackSize++;
+				while (InsertAt > FirstPushed && Stack[InsertAt - 1].TNear < TNear[Slot])
+				{
+					Stack[InsertAt] = Stack[InsertAt - 1];
+					--InsertAt;
+				}
+				Stack[InsertAt] = { Node.ChildIndex[Slot], Node.ChildNumTriangles[Slot], TNear[Slot], 1 };
+			}
+			continue;
+		}
+
+		for (int32 LeafSlot = Entry.Index; LeafSlot < Entry.Index + Entry.NumTriangles; ++LeafSlot)
+		{
+			const FTriangle& Triangle = Triangles[LeafSlot];
+			if ((Triangle.Mask & InstanceInclusionMask) == 0)
+			{
+				continue;
+			}
+
+			// Moller-Trumbore. Det > 0 when the ray travels against cross(Edge1, Edge2), i.e. it hits the front face.
+			const FVector P = Ray.Direction ^ Triangle.Edge2;
+			const float Det = Triangle.Edge1 | P;
+			if (bCullBackFaces ? Det <= 0.0f : Det == 0.0f)
+			{
+				continue;
+			}
+
+			const float InvDet = 1.0f / Det;
+			const FVector S = Ray.Origin - Triangle.V0;
+			const float U = (S | P) * InvDet;
+			if (U < 0.0f || U > 1.0f)
+			{
+				continue;
+			}
+
+			const FVector Q = S ^ Triangle.Edge1;
+			const float V = (Ray.Direction | Q) * InvDet;
+			if (V < 0.0f || U + V > 1.0f)
+			{
+				continue;
+			}
+
+			const float T = (Triangle.Edge2 | Q) * InvDet;
+			if (T >= Ray.TMin && T <= ClosestT)
+			{
+				ClosestT = T;
+				OutHit.T = T;
+				OutHit.TriangleIndex = TriangleIndices[LeafSlot];
+				OutHit.U = U;
+				OutHit.V = V;
+				OutHit.bFrontFace = Det > 0.0f;
+				if (bAcceptFirstHit)
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	return OutHit.IsHit();
+}
+
+void FCausticsBVH::TraceRayPacket(const FCausticsRay* Rays, int32 NumRays, uint32 RayFlags, uint32 InstanceInclusionMask, FCausticsHit* OutHits) const
+{
+	check(NumRays > 0 && NumRays <= PacketSize);
+	for (int32 Lane = 0; Lane < NumRays; ++Lane)
+	{
+		OutHits[Lane] = FCausticsHit();
+	}
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	const bool bCullBackFaces = (RayFlags & ECausticsRayFlags::CullBackFacingTriangles) != 0;
+
+	// Unused lanes replicate the first ray and are masked out
+	MS_ALIGN(16) float Lanes[10][PacketSize] GCC_ALIGN(16);
+	MS_ALIGN(16) float ClosestT[PacketSize] GCC_ALIGN(16);
+	for (int32 Lane = 0; Lane < PacketSize; ++Lane)
+	{
+		const FCausticsRay& Ray = Rays[Lane < NumRays ? Lane : 0];
+		Lanes[0][Lane] = Ray.Origin.X;
+		Lanes[1][Lane] = Ray.Origin.Y;
+		Lanes[2][Lane] = Ray.Origin.Z;
+		Lanes[3][Lane] = Ray.Direction.X;
+		Lanes[4][Lane] = Ray.Direction.Y;
+		Lanes[5][Lane] = Ray.Direction.Z;
+		Lanes[6][Lane] = 1.0f / Ray.Direction.X;
+		Lanes[7][Lane] = 1.0f / Ray.Direction.Y;
+		Lanes[8][Lane] = 1.0f / Ray.Direction.Z;
+		Lanes[9][Lane] = Ray.TMin;
+		ClosestT[Lane] = Ray.TMax;
+	}
+
+	FRayPacketSIMD Packet;
+	Packet.OriginX = VectorLoadAligned(Lanes[0]);
+	Packet.OriginY = VectorLoadAligned(Lanes[1]);
+	Packet.OriginZ = VectorLoadAligned(Lanes[2]);
+	Packet.DirectionX = VectorLoadAligned(Lanes[3]);
+	Packet.DirectionY = VectorLoadAligned(Lanes[4]);
+	Packet.DirectionZ = VectorLoadAligned(Lanes[5]);
+	Packet.InvDirectionX = VectorLoadAligned(Lanes[6]);
+	Packet.InvDirectionY = VectorLoadAligned(Lanes[7]);
+	Packet.InvDirectionZ = VectorLoadAligned(Lanes[8]);
+	Packet.TMin = VectorLoadAligned(Lanes[9]);
+	VectorRegister ClosestTRegister = VectorLoadAligned(ClosestT);
+
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister One = VectorOne();
+
+	FTraversalEntry Stack[MaxTraversalStackSize];
+	int32 StackSize = 0;
+	Stack[StackSize++] = { 0, 0, 0.0f, (1 << NumRays) - 1 };
+
+	while (StackSize > 0)
+	{
+		const FTraversalEntry Entry = Stack[--StackSize];
+
+		if (Entry.NumTriangles == 0)
+		{
+			const FNode& Node = Nodes[Entry.Index];
+
+			const int32 FirstPushed = StackSize;
+			for (int32 Slot = 0; Slot < 4; ++Slot)
+			{
+				if ((Node.ChildMask[Slot] & InstanceInclusionMask) == 0)
+				{
+					continue;
+				}
+
+				// One child box against every ray of the packet
+				const VectorRegister T0X = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.BoundsMinX[Slot]), Packet.OriginX), Packet.InvDirectionX);
+				const VectorRegister T1X = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.BoundsMaxX[Slot]), Packet.OriginX), Packet.InvDirectionX);
+				const VectorRegister T0Y = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.BoundsMinY[Slot]), Packet.OriginY), Packet.InvDirectionY);
+				const VectorRegister T1Y = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.BoundsMaxY[Slot]), Packet.OriginY), Packet.InvDirectionY);
+				const VectorRegister T0Z = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.BoundsMinZ[Slot]), Packet.OriginZ), Packet.InvDirectionZ);
+				const VectorRegister T1Z = VectorMultiply(VectorSubtract(VectorSetFloat1(Node.BoundsMaxZ[Slot]), Packet.OriginZ), Packet.InvDirectionZ);
+
+				const VectorRegister TNear = VectorMax(VectorMax(VectorMin(T0X, T1X), VectorMin(T0Y, T1Y)), VectorMax(VectorMin(T0Z, T1Z), Packet.TMin));
+				const VectorRegister TFar = VectorMin(VectorMin(VectorMax(T0X, T1X), VectorMax(T0Y, T1Y)), VectorMin(VectorMax(T0Z, T1Z), ClosestTRegister));
+
+				const int32 LaneMask = VectorMaskBits(VectorCompareGE(TFar, TNear)) & Entry.LaneMask;
+				if (LaneMask == 0)
+				{
+					continue;
+				}
+
+				// Order children by the entry distance of the first active lane
+				MS_ALIGN(16) float TNearLanes[PacketSize] GCC_ALIGN(16);
+				VectorStoreAligned(TNear, TNearLanes);
+				const float SortKey = TNearLanes[FMath::CountTrailingZeros(uint32(LaneMask))];
+
+				check(StackSize < MaxTraversalStackSize);
+				int32 InsertAt = StackSize++;
+				while (InsertAt > FirstPushed && Stack[InsertAt - 1].TNear < SortKey)
+				{
+					Stack[InsertAt] = Stack[InsertAt - 1];
+					--InsertAt;
+				}
+				Stack[InsertAt] = { Node.ChildIndex[Slot], Node.ChildNumTriangles[Slot], SortKey, LaneMask };
+			}
+			continue;
+		}
+
+		for (int32 LeafSlot = Entry.Index; LeafSlot < Entry.Index + Entry.NumTriangles; ++LeafSlot)
+		{
+			const FTriangle& Triangle = Triangles[LeafSlot];
+			if ((Triangle.Mask & InstanceInclusionMask) == 0)
+			{
+				continue;
+			}
+
+			// Moller-Trumbore, one triangle against every ray of the packet. Dot products accumulate in the order of
+			// FVector::operator| so that packets return bit identical hits to TraceRay().
+			const VectorRegister Edge1X = VectorSetFloat1(Triangle.Edge1.X);
+			const VectorRegister Edge1Y = VectorSetFloat1(Triangle.Edge1.Y);
+			const VectorRegister Edge1Z = VectorSetFloat1(Triangle.Edge1.Z);
+			const VectorRegister Edge2X = VectorSetFloat1(Triangle.Edge2.X);
+			const VectorRegister Edge2Y = VectorSetFloat1(Triangle.Edge2.Y);
+			const VectorRegister Edge2Z = VectorSetFloat1(Triangle.Edge2.Z);
+
+			const VectorRegister PX = VectorSubtract(VectorMultiply(Packet.DirectionY, Edge2Z), VectorMultiply(Packet.DirectionZ, Edge2Y));
+			const VectorRegister PY = VectorSubtract(VectorMultiply(Packet.DirectionZ, Edge2X), VectorMultiply(Packet.DirectionX, Edge2Z));
+			const VectorRegister PZ = VectorSubtract(VectorMultiply(Packet.DirectionX, Edge2Y), VectorMultiply(Packet.DirectionY, Edge2X));
+			const VectorRegister Det = VectorMultiplyAdd(Edge1Z, PZ, VectorMultiplyAdd(Edge1Y, PY, VectorMultiply(Edge1X, PX)));
+			const VectorRegister InvDet = VectorDivide(One, Det);
+
+			const VectorRegister SX = VectorSubtract(Packet.OriginX, VectorSetFloat1(Triangle.V0.X));
+			const VectorRegister SY = VectorSubtract(Packet.OriginY, VectorSetFloat1(Triangle.V0.Y));
+			const VectorRegister SZ = VectorSubtract(Packet.OriginZ, VectorSetFloat1(Triangle.V0.Z));
+			const VectorRegister U = VectorMultiply(VectorMultiplyAdd(SZ, PZ, VectorMultiplyAdd(SY, PY, VectorMultiply(SX, PX))), InvDet);
+
+			const VectorRegister QX = VectorSubtract(VectorMultiply(SY, Edge1Z), VectorMultiply(SZ, Edge1Y));
+			const VectorRegister QY = VectorSubtract(VectorMultiply(SZ, Edge1X), VectorMultiply(SX, Edge1Z));
+			const VectorRegister QZ = VectorSubtract(VectorMultiply(SX, Edge1Y), VectorMultiply(SY, Edge1X));
+			const VectorRegister V = VectorMultiply(VectorMultiplyAdd(Packet.DirectionZ, QZ, VectorMultiplyAdd(Packet.DirectionY, QY, VectorMultiply(Packet.DirectionX, QX))), InvDet);
+			const VectorRegister T = VectorMultiply(VectorMultiplyAdd(Edge2Z, QZ, VectorMultiplyAdd(Edge2Y, QY, VectorMultiply(Edge2X, QX))), InvDet);
+
+			const VectorRegister DetValid = bCullBackFaces ? VectorCompareGT(Det, Zero) : VectorCompareNE(Det, Zero);
+			const VectorRegister BarycentricsValid = VectorBitwiseAnd(
+				VectorBitwiseAnd(VectorCompareGE(U, Zero), VectorCompareGE(V, Zero)),
+				VectorCompareGE(One, VectorAdd(U, V)));
+			const VectorRegister DistanceValid = VectorBitwiseAnd(VectorCompareGE(T, Packet.TMin), VectorCompareGE(ClosestTRegister, T));
+
+			const int32 HitMask = VectorMaskBits(VectorBitwiseAnd(VectorBitwiseAnd(DetValid, BarycentricsValid), DistanceValid)) & Entry.LaneMask;
+			if (HitMask == 0)
+			{
+				continue;
+			}
+
+			MS_ALIGN(16) float TLanes[PacketSize] GCC_ALIGN(16);
+			MS_ALIGN(16) float ULanes[PacketSize] GCC_ALIGN(16);
+			MS_ALIGN(16) float VLanes[PacketSize] GCC_ALIGN(16);
+			MS_ALIGN(16) float DetLanes[PacketSize] GCC_ALIGN(16);
+			VectorStoreAligned(T, TLanes);
+			VectorStoreAligned(U, ULanes);
+			VectorStoreAligned(V, VLanes);
+			VectorStoreAligned(Det, DetLanes);
+
+			for (int32 Lane = 0; Lane < NumRays; ++Lane)
+			{
+				if (HitMask & (1 << Lane))
+				{
+					ClosestT[Lane] = TLanes[Lane];
+					FCausticsHit& Hit = OutHits[Lane];
+					Hit.T = TLanes[Lane];
+					Hit.TriangleIndex = TriangleIndices[LeafSlot];
+					Hit.U = ULanes[Lane];
+					Hit.V = VLanes[Lane];
+					Hit.bFrontFace = DetLanes[Lane] > 0.0f;
+				}
+			}
+			ClosestTRegister = VectorLoadAligned(ClosestT);
+		}
+	}
+}
+
+void FCausticsBVH::TraceRays(TArrayView<const FCausticsRay> Rays, uint32 RayFlags, uint32 InstanceInclusionMask, TArrayView<FCausticsHit> OutHits) const
+{
+	check(Rays.Num() == OutHits.Num());
+	for (int32 FirstRay = 0; FirstRay < Rays.Num(); FirstRay += PacketSize)
+	{
+		const int32 NumRays = FMath::Min(PacketSize, Rays.Num() - FirstRay);
+		TraceRayPacket(Rays.GetData() + FirstRay, NumRays, RayFlags, InstanceInclusionMask, OutHits.GetData() + FirstRay);
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FCausticsScene;
+
+// Mirrors the RAY_FLAG_* values used by RayTracingCaustics.usf
+namespace ECausticsRayFlags
+{
+	enum Type : uint32
+	{
+		None = 0,
+		AcceptFirstHitAndEndSearch = 0x04,
+		CullBackFacingTriangles = 0x10,
+	};
+}
+
+/** CPU counterpart of RayDesc */
+struct FCausticsRay
+{
+	FVector Origin = FVector::ZeroVector;
+	float TMin = 0.0f;
+	FVector Direction = FVector(1.0f, 0.0f, 0.0f);
+	float TMax = 1e27f;
+};
+
+/** Closest hit returned by the BVH. TriangleIndex is INDEX_NONE on a miss. */
+struct FCausticsHit
+{
+	float T = -1.0f;
+	int32 TriangleIndex = INDEX_NONE;
+	float U = 0.0f;
+	float V = 0.0f;
+	bool bFrontFace = false;
+
+	bool IsHit() const
+	{
+		return TriangleIndex != INDEX_NONE;
+	}
+};
+
+/**
+ * Four-wide bounding volume hierarchy over every triangle of a FCausticsScene.
+ * A binary binned SAH tree is built first and then collapsed so that every node holds the bounds of four children,
+ * laid out so that one VectorRegister covers the same coordinate of all of them.
+ *
+ * It stands in for the TLAS: instance masks are tested per triangle through the owning instance, and
+ * front faces follow the DXR convention for the winding documented in FCausticsScene.
+ */
+class FCausticsBVH
+{
+public:
+	/** Number of rays traced together by TraceRayPacket(), one per VectorRegister lane. */
+	static const int32 PacketSize = 4;
+
+	void Build(const FCausticsScene& Scene);
+
+	/** Returns whether anything was hit, OutHit holds the closest intersection in [Ray.TMin, Ray.TMax]. */
+	bool TraceRay(const FCausticsRay& Ray, uint32 RayFlags, uint32 InstanceInclusionMask, FCausticsHit& OutHit) const;
+
+	/**
+	 * Traces up to PacketSize rays through the tree together, sharing node fetches and testing every child box and
+	 * triangle against all rays at once. Pays off for coherent rays such as the primary rays of neighboring pixels.
+	 * AcceptFirstHitAndEndSearch is not honored per lane, those rays still return their closest hit.
+	 */
+	void TraceRayPacket(const FCausticsRay* Rays, int32 NumRays, uint32 RayFlags, uint32 InstanceInclusionMask, FCausticsHit* OutHits) const;
+
+	/** Traces a stream of rays as consecutive packets, callers should order the rays so that neighbors are coherent. */
+	void TraceRays(TArrayView<const FCausticsRay> Rays, uint32 RayFlags, uint32 InstanceInclusionMask, TArrayView<FCausticsHit> OutHits) const;
+
+	int32 NumNodes() const
+	{
+		return Nodes.Num();
+	}
+
+private:
+	/** Node of the intermediate binary tree. The first child directly follows its parent. */
+	struct FBinaryNode
+	{
+		FVector BoundsMin;
+		FVector BoundsMax;
+		/** Leaf: first entry in TriangleIndices. Interior: index of the second child. */
+		int32 Offset;
+		/** Number of triangles for a leaf, 0 for an interior node. */
+		int32 NumTriangles;
+		uint32 Mask;
+	};
+
+	MS_ALIGN(16) struct FNode
+	{
+		float BoundsMinX[4];
+		float BoundsMinY[4];
+		float BoundsMinZ[4];
+		float BoundsMaxX[4];
+		float BoundsMaxY[4];
+		float BoundsMaxZ[4];
+
+		/** Node index of an interior child, or first entry in TriangleIndices of a leaf child. */
+		int32 ChildIndex[4];
+		/** Number of triangles of a leaf child, 0 for interior children and unused slots. */
+		int32 ChildNumTriangles[4];
+		/** OR of the instance masks below each child, lets masked rays skip whole subtrees. 0 for unused slots. */
+		uint32 ChildMask[4];
+	} GCC_ALIGN(16);
+
+	/** Precomputed triangle data in the layout used by the intersection test. */
+	struct FTriangle
+	{
+		FVector V0;
+		FVector Edge1;
+		FVector Edge2;
+		uint32 Mask;
+	};
+
+	int32 BuildBinaryRecursive(TArray<FBinaryNode>& BinaryNodes, int32 FirstTriangle, int32 NumTriangles, const TArray<FVector>& Centroids, const TArray<FVector>& BoundsMin, const TArray<FVector>& BoundsMax);
+	int32 CollapseRecursive(const TArray<FBinaryNode>& BinaryNodes, int32 BinaryNodeIndex);
+
+	TArray<FNode> Nodes;
+	TArray<int32> TriangleIndices;
+	TArray<FTriangle> Triangles;
+};
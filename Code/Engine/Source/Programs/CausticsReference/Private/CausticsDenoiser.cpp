@@ -0,0 +1,82 @@
+#include "CausticsDenoiser.h"
+#include "Async/ParallelFor.h"
+
+float GetCausticsDenoiserKernelWeight(int32 Offset)
+{
+	static const float KernelWeights[CausticsDenoiserKernelRadius + 1] = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+	return KernelWeights[FMath::Abs(Offset)];
+}
+
+float GetCausticsDenoiserEdgeWeight(
+	const FVector4& Guide,
+	float Luminance,
+	const FVector4& SampleGuide,
+	float SampleLuminance,
+	float StepSize,
+	float NormalPower,
+	float DepthSigma,
+	float LuminanceSigma)
+{
+	const float NormalWeight = FMath::Pow(FMath::Clamp(FVector(Guide) | FVector(SampleGuide), 0.0f, 1.0f), NormalPower);
+	const float DepthWeight = FMath::Exp(-FMath::Abs(Guide.W - SampleGuide.W) / FMath::Max(DepthSigma * Guide.W * StepSize, 1e-4f));
+	const float LuminanceDifference = FMath::Abs(Luminance - SampleLuminance) / (FMath::Max(Luminance, SampleLuminance) + CausticsDenoiserMinLuminance);
+	const float LuminanceWeight = FMath::Exp(-FMath::Square(LuminanceDifference / FMath::Max(LuminanceSigma, 1e-4f)));
+	return NormalWeight * DepthWeight * LuminanceWeight;
+}
+
+void DenoiseCaustics(const FCausticsDenoiserParameters& Parameters, FIntPoint Size, const TArray<FVector4>& Guide, TArray<FLinearColor>& InOutColor, bool bForceSingleThread)
+{
+	check(Guide.Num() == Size.X * Size.Y && InOutColor.Num() == Size.X * Size.Y);
+
+	TArray<FLinearColor> Input;
+	for (int32 Iteration = 0; Iteration < Parameters.Iterations; ++Iteration)
+	{
+		const int32 StepSize = 1 << Iteration;
+		Input = InOutColor;
+
+		ParallelFor(Size.Y, [&](int32 Y)
+		{
+			for (int32 X = 0; X < Size.X; ++X)
+			{
+				const int32 Index = Y * Size.X + X;
+				if (Guide[Index].W <= 0.0f)
+				{
+					InOutColor[Index] = Input[Index];
+					continue;
+				}
+				const float Luminance = Input[Index].GetLuminance();
+
+				FLinearColor ColorSum(0.0f, 0.0f, 0.0f, 0.0f);
+				float WeightSum = 0.0f;
+				for (int32 OffsetY = -CausticsDenoiserKernelRadius; OffsetY <= CausticsDenoiserKernelRadius; ++OffsetY)
+				{
+					for (int32 OffsetX = -CausticsDenoiserKernelRadius; OffsetX <= CausticsDenoiserKernelRadius; ++OffsetX)
+					{
+						const FIntPoint SampleCoord(X + OffsetX * StepSize, Y + OffsetY * StepSize);
+						if (SampleCoord.X < 0 || SampleCoord.Y < 0 || SampleCoord.X >= Size.X || SampleCoord.Y >= Size.Y)
+						{
+							continue;
+						}
+
+						const int32 SampleIndex = SampleCoord.Y * Size.X + SampleCoord.X;
+						const float Weight = GetCausticsDenoiserKernelWeight(OffsetX) * GetCausticsDenoiserKernelWeight(OffsetY) * GetCausticsDenoiserEdgeWeight(
+							Guide[Index],
+							Luminance,
+							Guide[SampleIndex],
+							Input[SampleIndex].GetLuminance(),
+							float(StepSize),
+							Parameters.NormalPower,
+							Parameters.DepthSigma,
+							Parameters.LuminanceSigma);
+
+						ColorSum += Input[SampleIndex] * Weight;
+						WeightSum += Weight;
+					}
+				}
+
+				// The center always weighs in, so WeightSum is never 0
+				InOutColor[Index] = ColorSum / WeightSum;
+			}
+		}, bForceSingleThread);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/////////////////////////////////////////////////////////////////////////////////
+// CPU counterparts of RayTracingCausticsDenoiser.ush and RayTracingCausticsDenoiserCS.
+// The caustics are filtered by edge avoiding a-trous iterations guided by the normal and depth of the receivers,
+// and by the luminance of the caustics so that their sharp edges are kept.
+/////////////////////////////////////////////////////////////////////////////////
+
+/** Mirrors CAUSTICS_DENOISER_KERNEL_RADIUS. */
+static const int32 CausticsDenoiserKernelRadius = 2;
+
+/** Mirrors CAUSTICS_DENOISER_MIN_LUMINANCE. */
+static const float CausticsDenoiserMinLuminance = 1e-4f;
+
+/** Constants of the filter in RayTracingCaustics.cpp. */
+static const float DefaultCausticsDenoiserNormalPower = 64.0f;
+static const float DefaultCausticsDenoiserDepthSigma = 0.02f;
+
+struct FCausticsDenoiserParameters
+{
+	/** r.RayTracing.Caustics.Denoiser.Iterations */
+	int32 Iterations = 3;
+
+	/** r.RayTracing.Caustics.Denoiser.LuminanceSigma */
+	float LuminanceSigma = 0.5f;
+
+	float NormalPower = DefaultCausticsDenoiserNormalPower;
+	float DepthSigma = DefaultCausticsDenoiserDepthSigma;
+};
+
+/** GetCausticsDenoiserKernelWeight(): B3 spline weight of the tap Offset steps away from the center. */
+float GetCausticsDenoiserKernelWeight(int32 Offset);
+
+/** GetCausticsDenoiserEdgeWeight(): Guide holds the receiver normal in xyz and its scene depth in w. */
+float GetCausticsDenoiserEdgeWeight(
+	const FVector4& Guide,
+	float Luminance,
+	const FVector4& SampleGuide,
+	float SampleLuminance,
+	float StepSize,
+	float NormalPower,
+	float DepthSigma,
+	float LuminanceSigma);
+
+/**
+ * Every RayTracingCausticsDenoiserCS iteration over Color, in place. Guide is what the shader reads from the G-buffer
+ * for each texel, a depth of 0 marks the sky which is left untouched.
+ */
+void DenoiseCaustics(const FCausticsDenoiserParameters& Parameters, FIntPoint Size, const TArray<FVector4>& Guide, TArray<FLinearColor>& InOutColor, bool bForceSingleThread);
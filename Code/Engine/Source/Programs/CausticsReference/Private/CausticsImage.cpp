@@ -0,0 +1,101 @@
+#include "CausticsImage.h"
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	/** PFM stores rows bottom to top, a negative scale marks little endian data. */
+	bool WritePFM(const TCHAR* Filename, FIntPoint Size, int32 NumChannels, TFunctionRef<float(int32 PixelIndex, int32 Channel)> GetValue)
+	{
+		const FString Header = FString::Printf(TEXT("%s\n%d %d\n-1.0\n"), NumChannels == 3 ? TEXT("PF") : TEXT("Pf"), Size.X, Size.Y);
+
+		TArray<uint8> Bytes;
+		Bytes.Reserve(Header.Len() + Size.X * Size.Y * NumChannels * sizeof(float));
+		for (int32 CharIndex = 0; CharIndex < Header.Len(); ++CharIndex)
+		{
+			Bytes.Add(uint8((*Header)[CharIndex]));
+		}
+
+		for (int32 Y = Size.Y - 1; Y >= 0; --Y)
+		{
+			for (int32 X = 0; X < Size.X; ++X)
+			{
+				for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+				{
+					const float Value = GetValue(Y * Size.X + X, Channel);
+					const int32 Offset = Bytes.AddUninitialized(sizeof(float));
+					FMemory::Memcpy(&Bytes[Offset], &Value, sizeof(float));
+				}
+			}
+		}
+		return FFileHelper::SaveArrayToFile(Bytes, Filename);
+	}
+}
+
+bool WriteColorPFM(const TCHAR* Filename, FIntPoint Size, const TArray<FLinearColor>& Pixels)
+{
+	check(Pixels.Num() == Size.X * Size.Y);
+	return WritePFM(Filename, Size, 3, [&Pixels](int32 PixelIndex, int32 Channel)
+	{
+		return Pixels[PixelIndex].Component(Channel);
+	});
+}
+
+bool WriteGrayscalePFM(const TCHAR* Filename, FIntPoint Size, const TArray<float>& Pixels)
+{
+	check(Pixels.Num() == Size.X * Size.Y);
+	return WritePFM(Filename, Size, 1, [&Pixels](int32 PixelIndex, int32 Channel)
+	{
+		return Pixels[PixelIndex];
+	});
+}
+
+bool ReadColorPFM(const TCHAR* Filename, FIntPoint& OutSize, TArray<FLinearColor>& OutPixels)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, Filename))
+	{
+		return false;
+	}
+
+	// Three whitespace terminated header lines: the format, the size and the scale
+	FString Header[3];
+	int32 Offset = 0;
+	for (FString& Line : Header)
+	{
+		while (Offset < Bytes.Num() && Bytes[Offset] != '\n')
+		{
+			Line.AppendChar(TCHAR(Bytes[Offset++]));
+		}
+		++Offset;
+	}
+
+	FString Width;
+	FString Height;
+	if (Header[0] != TEXT("PF") || !Header[1].Split(TEXT(" "), &Width, &Height) || FCString::Atof(*Header[2]) >= 0.0f)
+	{
+		return false;
+	}
+
+	OutSize = FIntPoint(FCString::Atoi(*Width), FCString::Atoi(*Height));
+	const int32 NumPixels = OutSize.X * OutSize.Y;
+	if (OutSize.X <= 0 || OutSize.Y <= 0 || Bytes.Num() - Offset != NumPixels * 3 * int32(sizeof(float)))
+	{
+		return false;
+	}
+
+	OutPixels.SetNumUninitialized(NumPixels);
+	for (int32 Y = OutSize.Y - 1; Y >= 0; --Y)
+	{
+		for (int32 X = 0; X < OutSize.X; ++X)
+		{
+			FLinearColor& Pixel = OutPixels[Y * OutSize.X + X];
+			Pixel.A = 1.0f;
+			for (int32 Channel = 0; Channel < 3; ++Channel)
+			{
+				FMemory::Memcpy(&Pixel.Component(Channel), &Bytes[Offset], sizeof(float));
+				Offset += sizeof(float);
+			}
+		}
+	}
+	return true;
+}
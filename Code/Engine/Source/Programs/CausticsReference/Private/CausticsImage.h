@@ -0,0 +1,10 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Portable float map writers, so that outputs can be diffed bit for bit and opened in most HDR viewers. */
+bool WriteColorPFM(const TCHAR* Filename, FIntPoint Size, const TArray<FLinearColor>& Pixels);
+bool WriteGrayscalePFM(const TCHAR* Filename, FIntPoint Size, const TArray<float>& Pixels);
+
+/** Reads a little endian color PFM as written by WriteColorPFM(), alpha is 1. */
+bool ReadColorPFM(const TCHAR* Filename, FIntPoint& OutSize, TArray<FLinearColor>& OutPixels);
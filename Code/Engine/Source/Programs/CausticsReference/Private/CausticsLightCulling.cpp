@@ -0,0 +1,215 @@
+#include "CausticsLightCulling.h"
+#include "CausticsScene.h"
+#include "CausticsShaderMath.h"
+#include "CausticsView.h"
+#include "Async/ParallelFor.h"
+
+float GetCausticsLightCullingSliceDepth(int32 Slice)
+{
+	if (Slice == 0)
+	{
+		return 0.0f;
+	}
+	return CausticsLightCullingMinDepth * FMath::Pow(CausticsLightCullingMaxDepth / CausticsLightCullingMinDepth, float(Slice) / CausticsLightCullingNumSlices);
+}
+
+int32 GetCausticsLightCullingSlice(float Depth)
+{
+	// Depths under the first slice give a negative or infinite log, which the clamp maps to slice 0
+	const float Slice = FMath::Log2(Depth / CausticsLightCullingMinDepth) / FMath::Log2(CausticsLightCullingMaxDepth / CausticsLightCullingMinDepth) * CausticsLightCullingNumSlices;
+	return Depth > 0.0f ? int32(FMath::Clamp(FMath::FloorToFloat(Slice), 0.0f, float(CausticsLightCullingNumSlices))) : 0;
+}
+
+bool DoesCausticsLightReachBounds(const FCausticsLight& Light, const FVector4& Bounds)
+{
+	if (Light.Type > ECausticsLightType::Rect)
+	{
+		return false;
+	}
+	if (Light.Type == ECausticsLightType::Directional)
+	{
+		return true;
+	}
+
+	const FVector ToBounds = FVector(Bounds) - Light.LightPosition;
+	const float Distance = ToBounds.Size();
+	const float Reach = Bounds.W + Light.SourceRadius + Light.SourceLength;
+	if (Distance <= Reach)
+	{
+		return true;
+	}
+
+	// An InvRadius of 0 is a light without attenuation radius
+	if (Light.InvRadius > 0.0f && Distance - Reach > 1.0f / Light.InvRadius)
+	{
+		return false;
+	}
+
+	// Direction points back towards the light
+	if (Light.Type == ECausticsLightType::Spot)
+	{
+		const float AxisAngle = FMath::Acos(FMath::Clamp((-ToBounds / Distance) | Light.Direction, -1.0f, 1.0f));
+		const float BoundsAngle = FMath::Asin(Saturate(Reach / Distance));
+		return AxisAngle - BoundsAngle <= FMath::Acos(FMath::Clamp(Light.SpotAngles.X, -1.0f, 1.0f));
+	}
+	if (Light.Type == ECausticsLightType::Rect)
+	{
+		return (-ToBounds | Light.Direction) + Bounds.W > 0.0f;
+	}
+	return true;
+}
+
+bool IsCausticsEmitterTargetBetween(const FCausticsLight& Light, const FVector4& Bounds, const FVector4& Target)
+{
+	const FVector BoundsCenter(Bounds);
+	FVector End;
+	float EndRadius;
+	if (Light.Type == ECausticsLightType::Directional)
+	{
+		// Occlusion rays of directional lights jitter the unit direction within a disk of SourceRadius, the tangent of the half angle
+		End = BoundsCenter + Light.Direction * CausticsLightCullingDirectionalDistance;
+		EndRadius = Bounds.W + Light.SourceRadius * CausticsLightCullingDirectionalDistance;
+	}
+	else
+	{
+		End = Light.LightPosition;
+		EndRadius = Light.SourceRadius + Light.SourceLength;
+	}
+
+	const FVector Axis = End - BoundsCenter;
+	const float Length = Axis.Size();
+	if (Length <= Bounds.W + EndRadius)
+	{
+		return true;
+	}
+
+	// Distance to the axis against the radius of the cone there, the slope accounts for the cone surface not being parallel to the axis
+	const FVector TargetCenter(Target);
+	const float AxisT = Saturate(((TargetCenter - BoundsCenter) | Axis) / FMath::Square(Length));
+	const float DistanceToAxis = (BoundsCenter + Axis * AxisT - TargetCenter).Size();
+	const float Slope = (EndRadius - Bounds.W) / Length;
+	return DistanceToAxis <= FMath::Lerp(Bounds.W, EndRadius, AxisT) + Target.W * FMath::Sqrt(1.0f + FMath::Square(Slope));
+}
+
+FVector4 FCausticsLightCulling::GetClusterBounds(const FCausticsView& View, int32 UpscaleFactor, FIntPoint TileCoord, int32 Slice) const
+{
+	const FIntPoint ThreadMin = TileCoord * CausticsLightCullingTileSize;
+	const FIntPoint ThreadMax = ThreadMin + FIntPoint(CausticsLightCullingTileSize - 1, CausticsLightCullingTileSize - 1);
+	const FVector2D InvBufferSize = View.GetInvBufferSize();
+	const FIntPoint PixelMin = View.GetPixelCoord(ThreadMin, UpscaleFactor);
+	const FIntPoint PixelMax = View.GetPixelCoord(ThreadMax, UpscaleFactor) + FIntPoint(1, 1);
+	const FVector2D UVMin(PixelMin.X * InvBufferSize.X, PixelMin.Y * InvBufferSize.Y);
+	const FVector2D UVMax(PixelMax.X * InvBufferSize.X, PixelMax.Y * InvBufferSize.Y);
+	const float NearDepth = GetCausticsLightCullingSliceDepth(Slice) * 0.99f;
+	const float FarDepth = GetCausticsLightCullingSliceDepth(Slice + 1) * 1.01f;
+
+	FVector Corners[8];
+	for (int32 CornerIndex = 0; CornerIndex < 4; ++CornerIndex)
+	{
+		const FVector2D UV((CornerIndex & 1) ? UVMax.X : UVMin.X, (CornerIndex & 2) ? UVMax.Y : UVMin.Y);
+		const FVector Direction = View.CreatePrimaryRay(UV).Direction;
+		const float DepthToDistance = 1.0f / (Direction | View.ViewForward);
+		Corners[CornerIndex * 2 + 0] = View.WorldCameraOrigin + Direction * (NearDepth * DepthToDistance);
+		Corners[CornerIndex * 2 + 1] = View.WorldCameraOrigin + Direction * (FarDepth * DepthToDistance);
+	}
+
+	FVector Center = FVector::ZeroVector;
+	for (const FVector& Corner : Corners)
+	{
+		Center += Corner * 0.125f;
+	}
+	float Radius = 0.0f;
+	for (const FVector& Corner : Corners)
+	{
+		Radius = FMath::Max(Radius, (Corner - Center).Size());
+	}
+	return FVector4(Center, Radius);
+}
+
+void FCausticsLightCulling::Build(const FCausticsView& View, int32 UpscaleFactor, FIntPoint DispatchSize, const TArray<FCausticsLight>& Lights, const TArray<FVector4>& Targets, bool bForceSingleThread)
+{
+	TileCount = FIntPoint::DivideAndRoundUp(DispatchSize, CausticsLightCullingTileSize);
+	Masks.Init(0, TileCount.X * TileCount.Y * CausticsLightCullingNumSlices * CausticsLightCullingMaskWords);
+
+	const int32 NumCulledLights = FMath::Min(Lights.Num(), CausticsLightCullingMaxLights);
+	ParallelFor(TileCount.Y * CausticsLightCullingNumSlices, [&](int32 DispatchY)
+	{
+		const int32 Slice = DispatchY / TileCount.Y;
+		for (int32 TileX = 0; TileX < TileCount.X; ++TileX)
+		{
+			const FIntPoint TileCoord(TileX, DispatchY % TileCount.Y);
+			const FVector4 Bounds = GetClusterBounds(View, UpscaleFactor, TileCoord, Slice);
+			uint32* Mask = &Masks[GetClusterIndex(TileCoord, Slice) * CausticsLightCullingMaskWords];
+
+			for (int32 LightIndex = 0; LightIndex < NumCulledLights; ++LightIndex)
+			{
+				if (!DoesCausticsLightReachBounds(Lights[LightIndex], Bounds))
+				{
+					continue;
+				}
+
+				for (const FVector4& Target : Targets)
+				{
+					if (IsCausticsEmitterTargetBetween(Lights[LightIndex], Bounds, Target))
+					{
+						Mask[LightIndex / 32] |= 1u << (LightIndex % 32);
+						break;
+					}
+				}
+			}
+		}
+	}, bForceSingleThread);
+}
+
+int32 FCausticsLightCulling::GetCluster(const FCausticsView& View, FIntPoint DispatchThreadId, const FVector& WorldPosition) const
+{
+	const int32 Slice = GetCausticsLightCullingSlice((WorldPosition - View.WorldCameraOrigin) | View.ViewForward);
+	if (Masks.Num() == 0 || Slice >= CausticsLightCullingNumSlices)
+	{
+		return INDEX_NONE;
+	}
+	return GetClusterIndex(FIntPoint(DispatchThreadId.X / CausticsLightCullingTileSize, DispatchThreadId.Y / CausticsLightCullingTileSize), Slice);
+}
+
+int32 FCausticsLightCulling::GetNextLight(int32 ClusterIndex, int32 LightIndex) const
+{
+	const int32 Candidate = LightIndex + 1;
+	if (ClusterIndex == INDEX_NONE || Candidate >= CausticsLightCullingMaxLights)
+	{
+		return Candidate;
+	}
+
+	const uint32* Mask = &Masks[ClusterIndex * CausticsLightCullingMaskWords];
+	for (int32 Word = Candidate / 32; Word < CausticsLightCullingMaskWords; ++Word)
+	{
+		uint32 Bits = Mask[Word];
+		if (Word == Candidate / 32)
+		{
+			Bits &= ~0u << (Candidate % 32);
+		}
+		if (Bits != 0)
+		{
+			return Word * 32 + int32(FMath::CountTrailingZeros(Bits));
+		}
+	}
+	return CausticsLightCullingMaxLights;
+}
+
+bool FCausticsLightCulling::IsLightInCluster(int32 ClusterIndex, int32 LightIndex) const
+{
+	if (ClusterIndex == INDEX_NONE || LightIndex >= CausticsLightCullingMaxLights)
+	{
+		return true;
+	}
+	return (Masks[ClusterIndex * CausticsLightCullingMaskWords + LightIndex / 32] & (1u << (LightIndex % 32))) != 0;
+}
+
+int64 FCausticsLightCulling::CountLights() const
+{
+	int64 Count = 0;
+	for (uint32 Word : Masks)
+	{
+		Count += FMath::CountBits(Word);
+	}
+	return Count;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FCausticsLight;
+struct FCausticsView;
+
+/////////////////////////////////////////////////////////////////////////////////
+// CPU counterparts of RayTracingCausticsLightCulling.ush and RayTracingCausticsLightCullingCS.
+// The screen dispatch is split into clusters of tiles by exponential depth slices, and every cluster keeps a bit mask
+// of the lights that reach it with a translucent instance in between.
+/////////////////////////////////////////////////////////////////////////////////
+
+/** Mirrors CAUSTICS_LIGHT_CULLING_TILE_SIZE: dispatch threads per side of a tile. */
+static const int32 CausticsLightCullingTileSize = 32;
+
+/** Mirrors CAUSTICS_LIGHT_CULLING_NUM_SLICES, CAUSTICS_LIGHT_CULLING_MIN_DEPTH and CAUSTICS_LIGHT_CULLING_MAX_DEPTH. */
+static const int32 CausticsLightCullingNumSlices = 32;
+static const float CausticsLightCullingMinDepth = 10.0f;
+static const float CausticsLightCullingMaxDepth = 100000.0f;
+
+/** Mirrors CAUSTICS_LIGHT_CULLING_MAX_LIGHTS and CAUSTICS_LIGHT_CULLING_MASK_WORDS. */
+static const int32 CausticsLightCullingMaxLights = 256;
+static const int32 CausticsLightCullingMaskWords = CausticsLightCullingMaxLights / 32;
+
+/** Mirrors CAUSTICS_LIGHT_CULLING_DIRECTIONAL_DISTANCE. */
+static const float CausticsLightCullingDirectionalDistance = 1000000.0f;
+
+/** GetCausticsLightCullingSliceDepth(): view depth where a slice starts. */
+float GetCausticsLightCullingSliceDepth(int32 Slice);
+
+/** GetCausticsLightCullingSlice(): CausticsLightCullingNumSlices past the last slice. */
+int32 GetCausticsLightCullingSlice(float Depth);
+
+/** DoesCausticsLightReachBounds(): attenuation radius, spot cone and rect light plane against the sphere Bounds (center in xyz, radius in w). */
+bool DoesCausticsLightReachBounds(const FCausticsLight& Light, const FVector4& Bounds);
+
+/** IsCausticsEmitterTargetBetween(): whether the sphere Target may block occlusion rays from the sphere Bounds towards the light. */
+bool IsCausticsEmitterTargetBetween(const FCausticsLight& Light, const FVector4& Bounds, const FVector4& Target);
+
+/** The light masks written by RayTracingCausticsLightCullingCS and the lookups of the caustics ray generation shader. */
+class FCausticsLightCulling
+{
+public:
+	/** Builds the masks of every cluster of a screen dispatch, as the culling pass does. */
+	void Build(const FCausticsView& View, int32 UpscaleFactor, FIntPoint DispatchSize, const TArray<FCausticsLight>& Lights, const TArray<FVector4>& Targets, bool bForceSingleThread);
+
+	/** GetCausticsLightCullingClusterBounds(): bounding sphere of the world positions a cluster covers. */
+	FVector4 GetClusterBounds(const FCausticsView& View, int32 UpscaleFactor, FIntPoint TileCoord, int32 Slice) const;
+
+	/** GetCausticsLightCullingCluster(): INDEX_NONE when the hit is not culled, which includes a culling that was never built. */
+	int32 GetCluster(const FCausticsView& View, FIntPoint DispatchThreadId, const FVector& WorldPosition) const;
+
+	/** GetNextCausticsLight(): the next light of the cluster after LightIndex, at least CausticsLightCullingMaxLights past the last one. */
+	int32 GetNextLight(int32 ClusterIndex, int32 LightIndex) const;
+
+	int32 GetFirstLight(int32 ClusterIndex) const
+	{
+		return GetNextLight(ClusterIndex, -1);
+	}
+
+	/** IsCausticsLightInCluster(): lights past the masks and hits that are not culled keep every light. */
+	bool IsLightInCluster(int32 ClusterIndex, int32 LightIndex) const;
+
+	int32 NumClusters() const
+	{
+		return Masks.Num() / CausticsLightCullingMaskWords;
+	}
+
+	/** Set bits over all clusters, for the statistics. */
+	int64 CountLights() const;
+
+private:
+	int32 GetClusterIndex(FIntPoint TileCoord, int32 Slice) const
+	{
+		return (Slice * TileCount.Y + TileCoord.Y) * TileCount.X + TileCoord.X;
+	}
+
+	FIntPoint TileCount = FIntPoint::ZeroValue;
+	TArray<uint32> Masks;
+};
@@ -0,0 +1,149 @@
+#include "CausticsLightSampling.h"
+#include "CausticsLightCulling.h"
+#include "CausticsScene.h"
+
+float GetCausticsLightSelectionWeight(const FCausticsLight& Light, const FVector& ViewOrigin)
+{
+	if (Light.Type > ECausticsLightType::Rect)
+	{
+		return 0.0f;
+	}
+
+	// Luminance() from Common.ush
+	const float Power = Light.LightColor | FVector(0.3f, 0.59f, 0.11f);
+	if (Light.Type == ECausticsLightType::Directional)
+	{
+		return Power;
+	}
+
+	return Power / FMath::Max(FVector::DistSquared(ViewOrigin, Light.LightPosition), FMath::Square(CausticsLightSamplingMinDistance));
+}
+
+void BuildCausticsLightAliasTable(TArrayView<const float> Weights, TArray<FCausticsLightAliasEntry>& OutTable)
+{
+	const int32 NumLights = FMath::Min(Weights.Num(), CausticsLightSamplingMaxLights);
+
+	float TotalWeight = 0.0f;
+	for (int32 LightIndex = 0; LightIndex < NumLights; ++LightIndex)
+	{
+		TotalWeight += Weights[LightIndex];
+	}
+
+	// Scaled weights average to 1, each entry takes the probability missing under 1 from a light above 1
+	TArray<float> ScaledWeights;
+	TArray<int32> Small;
+	TArray<int32> Large;
+	ScaledWeights.SetNumUninitialized(NumLights);
+	OutTable.SetNum(NumLights);
+	for (int32 LightIndex = 0; LightIndex < NumLights; ++LightIndex)
+	{
+		FCausticsLightAliasEntry& Entry = OutTable[LightIndex];
+		Entry.Threshold = 1.0f;
+		Entry.Alias = LightIndex;
+		Entry.Pdf = TotalWeight > 0.0f ? Weights[LightIndex] / TotalWeight : 0.0f;
+
+		ScaledWeights[LightIndex] = Entry.Pdf * NumLights;
+		if (ScaledWeights[LightIndex] < 1.0f)
+		{
+			Small.Add(LightIndex);
+		}
+		else
+		{
+			Large.Add(LightIndex);
+		}
+	}
+
+	if (TotalWeight <= 0.0f)
+	{
+		// Every entry keeps a Pdf of 0 and the light loop skips whatever it draws
+		return;
+	}
+
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		const int32 SmallIndex = Small.Pop(false);
+		const int32 LargeIndex = Large.Pop(false);
+		OutTable[SmallIndex].Threshold = ScaledWeights[SmallIndex];
+		OutTable[SmallIndex].Alias = LargeIndex;
+
+		ScaledWeights[LargeIndex] = (ScaledWeights[LargeIndex] + ScaledWeights[SmallIndex]) - 1.0f;
+		if (ScaledWeights[LargeIndex] < 1.0f)
+		{
+			Small.Add(LargeIndex);
+		}
+		else
+		{
+			Large.Add(LargeIndex);
+		}
+	}
+	// Whatever is left is 1 up to rounding and keeps its own light
+}
+
+int32 SampleCausticsLightAliasTable(const TArray<FCausticsLightAliasEntry>& Table, float RandSample, float& OutPdf)
+{
+	const int32 NumLights = Table.Num();
+	const float ScaledSample = RandSample * NumLights;
+	const int32 EntryIndex = FMath::Min(int32(ScaledSample), NumLights - 1);
+	const FCausticsLightAliasEntry& Entry = Table[EntryIndex];
+	const int32 LightIndex = ScaledSample - EntryIndex < Entry.Threshold ? EntryIndex : Entry.Alias;
+	OutPdf = Table[LightIndex].Pdf;
+	return LightIndex;
+}
+
+FCausticsLightLoop::FCausticsLightLoop(
+	const FCausticsLightCulling& InLightCulling,
+	const TArray<FCausticsLightAliasEntry>& InAliasTable,
+	int32 InNumSamples,
+	int32 InClusterIndex,
+	int32 InNumLights,
+	FCausticsRandomSequence& RandSequence)
+	: LightCulling(InLightCulling)
+	, AliasTable(InAliasTable)
+	, NumSamples(InNumSamples)
+	, ClusterIndex(InClusterIndex)
+	, NumLights(InNumLights)
+{
+	if (NumSamples == 0)
+	{
+		LightIndex = LightCulling.GetFirstLight(ClusterIndex);
+	}
+	else if (NumLights > 0)
+	{
+		Sample(RandSequence);
+	}
+}
+
+bool FCausticsLightLoop::IsDone() const
+{
+	if (NumSamples == 0)
+	{
+		return LightIndex >= NumLights;
+	}
+	return NumLights == 0 || Iteration >= NumSamples;
+}
+
+void FCausticsLightLoop::Advance(FCausticsRandomSequence& RandSequence)
+{
+	Iteration++;
+	if (NumSamples == 0)
+	{
+		LightIndex = LightCulling.GetNextLight(ClusterIndex, LightIndex);
+	}
+	else if (Iteration < NumSamples)
+	{
+		Sample(RandSequence);
+	}
+}
+
+void FCausticsLightLoop::Sample(FCausticsRandomSequence& RandSequence)
+{
+	const float RandSample = RandomSequence_GenerateSample1D(RandSequence);
+
+	// The table covers the first CausticsLightSamplingMaxLights lights, like the one built by the renderer
+	float Pdf;
+	LightIndex = SampleCausticsLightAliasTable(AliasTable, RandSample, Pdf);
+
+	// Culled lights do not reach the cluster through a translucent instance, they would contribute nothing
+	const bool bValid = Pdf > 0.0f && LightCulling.IsLightInCluster(ClusterIndex, LightIndex);
+	LightWeight = bValid ? 1.0f / (NumSamples * Pdf) : 0.0f;
+}
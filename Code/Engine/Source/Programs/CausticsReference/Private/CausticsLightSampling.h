@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CausticsRandomSequence.h"
+
+class FCausticsLightCulling;
+struct FCausticsLight;
+
+/////////////////////////////////////////////////////////////////////////////////
+// CPU counterparts of RayTracingCausticsLightSampling.ush and of the alias table RayTracingCaustics.cpp builds.
+// The screen light loop can draw a fixed number of lights per pixel from an alias table weighted by the estimated
+// irradiance of each light at the viewer, and divides every drawn light by the probability it was picked with.
+/////////////////////////////////////////////////////////////////////////////////
+
+/** Mirrors CAUSTICS_LIGHT_SAMPLING_MAX_LIGHTS. */
+static const int32 CausticsLightSamplingMaxLights = 256;
+
+/** Mirrors CAUSTICS_LIGHT_SAMPLING_MIN_DISTANCE. */
+static const float CausticsLightSamplingMinDistance = 100.0f;
+
+/** Mirrors FCausticsLightAliasEntry. */
+struct FCausticsLightAliasEntry
+{
+	float Threshold = 1.0f;
+	int32 Alias = 0;
+	float Pdf = 0.0f;
+};
+
+/** GetCausticsLightSelectionWeight(): irradiance of the light at ViewOrigin without attenuation radius or shadowing. */
+float GetCausticsLightSelectionWeight(const FCausticsLight& Light, const FVector& ViewOrigin);
+
+/** BuildCausticsLightAliasTable() of RayTracingCaustics.cpp: Vose's alias table over the first CausticsLightSamplingMaxLights weights. */
+void BuildCausticsLightAliasTable(TArrayView<const float> Weights, TArray<FCausticsLightAliasEntry>& OutTable);
+
+/** SampleCausticsLightAliasTable(): picks an entry of the table with a uniform RandSample and returns its probability in OutPdf. */
+int32 SampleCausticsLightAliasTable(const TArray<FCausticsLightAliasEntry>& Table, float RandSample, float& OutPdf);
+
+/**
+ * FCausticsLightLoop of the shader: every light of the light culling cluster in order when NumSamples is 0,
+ * NumSamples lights drawn from the alias table otherwise.
+ */
+class FCausticsLightLoop
+{
+public:
+	FCausticsLightLoop(
+		const FCausticsLightCulling& InLightCulling,
+		const TArray<FCausticsLightAliasEntry>& InAliasTable,
+		int32 InNumSamples,
+		int32 InClusterIndex,
+		int32 InNumLights,
+		FCausticsRandomSequence& RandSequence);
+
+	bool IsDone() const;
+	void Advance(FCausticsRandomSequence& RandSequence);
+
+	/** Lights visited or drawn so far. */
+	int32 GetIteration() const
+	{
+		return Iteration;
+	}
+
+	int32 LightIndex = 0;
+
+	/** Scale of the contribution of LightIndex, 0 when the light must be skipped. */
+	float LightWeight = 1.0f;
+
+private:
+	void Sample(FCausticsRandomSequence& RandSequence);
+
+	const FCausticsLightCulling& LightCulling;
+	const TArray<FCausticsLightAliasEntry>& AliasTable;
+	int32 NumSamples;
+	int32 ClusterIndex;
+	int32 NumLights;
+	int32 Iteration = 0;
+};
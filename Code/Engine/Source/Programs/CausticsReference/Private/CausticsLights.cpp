@@ -0,0 +1,246 @@
+#include "CausticsLights.h"
+#include "CausticsScene.h"
+#include "CausticsShaderMath.h"
+
+namespace
+{
+	void GetRectLightTangentsWithLightingData(const FCausticsLight& LightParameters, FVector& OutTangent, FVector& OutBiTangent)
+	{
+		OutTangent = LightParameters.Tangent ^ LightParameters.Direction;
+		OutBiTangent = LightParameters.Tangent;
+	}
+
+	bool GenerateSphereLightOcclusionRayWithLightingData(const FCausticsLight& LightParameters, const FVector& WorldPosition, const FVector2D& RandSample, FCausticsRay& OutRay)
+	{
+		const FVector4 Result = UniformSampleSphere(RandSample);
+		const FVector LightNormal(Result.X, Result.Y, Result.Z);
+		const FVector LightPosition = LightParameters.LightPosition + LightNormal * LightParameters.SourceRadius;
+		const FVector LightDirection = LightPosition - WorldPosition;
+		const float RayLength = LightDirection.Size();
+
+		OutRay.Origin = WorldPosition;
+		OutRay.Direction = LightDirection / RayLength;
+		OutRay.TMin = 0.0f;
+		OutRay.TMax = RayLength;
+		return true;
+	}
+
+	bool GenerateDiskLightOcclusionRayWithLightingData(const FCausticsLight& LightParameters, const FVector& WorldPosition, const FVector2D& RandSample, FCausticsRay& OutRay)
+	{
+		OutRay.Origin = WorldPosition;
+		OutRay.Direction = FVector::ZeroVector;
+		OutRay.TMin = 0.01f;
+		OutRay.TMax = OutRay.TMin;
+
+		// Sample disk of SourceRadius
+		const FVector2D UV = UniformSampleDiskConcentric(RandSample) * LightParameters.SourceRadius;
+		const FVector BiTangent = LightParameters.Direction ^ LightParameters.Tangent;
+		const FVector World = LightParameters.LightPosition + LightParameters.Tangent * UV.X + BiTangent * UV.Y;
+
+		// Construct light direction according to sample
+		FVector LightDirection = World - WorldPosition;
+		const float RayLength = LightDirection.Size();
+		LightDirection /= RayLength;
+
+		// Apply normal culling
+		const bool bIsVisible = (LightDirection | LightParameters.Direction) > 0.0f;
+		if (bIsVisible)
+		{
+			OutRay.Direction = LightDirection;
+			OutRay.TMax = RayLength;
+		}
+		return bIsVisible;
+	}
+
+	bool GeneratePointLightOcclusionRayWithLightingData(const FCausticsLight& LightParameters, const FVector& WorldPosition, FCausticsRay& OutRay)
+	{
+		const FVector LightDirection = LightParameters.LightPosition - WorldPosition;
+		const float RayLength = LightDirection.Size();
+
+		OutRay.Origin = WorldPosition;
+		OutRay.Direction = LightDirection / RayLength;
+		OutRay.TMin = 0.0f;
+		OutRay.TMax = RayLength;
+		return true;
+	}
+
+	bool GenerateRectLightOcclusionRayWithLightingData(const FCausticsLight& LightParameters, const FVector& WorldPosition, FVector2D RandSample, FCausticsRay& OutRay)
+	{
+		OutRay.Origin = WorldPosition;
+		OutRay.Direction = FVector::ZeroVector;
+		OutRay.TMin = 0.0f;
+		OutRay.TMax = 0.0f;
+
+		FVector Tangent;
+		FVector BiTangent;
+		GetRectLightTangentsWithLightingData(LightParameters, Tangent, BiTangent);
+		const FVector2D LightDimensions(2.0f * LightParameters.SourceRadius, 2.0f * LightParameters.SourceLength);
+
+		// Map sample point to quad
+		RandSample = RandSample - 0.5f;
+		const FVector LightSamplePosition = LightParameters.LightPosition + Tangent * (LightDimensions.X * RandSample.X) + BiTangent * (LightDimensions.Y * RandSample.Y);
+		const FVector LightDirection = (LightSamplePosition - WorldPosition).GetSafeNormal();
+
+		// Light-normal culling
+		if ((-LightDirection | -LightParameters.Direction) <= 0.0f)
+		{
+			return false;
+		}
+
+		OutRay.Direction = LightDirection;
+		OutRay.TMax = (LightSamplePosition - WorldPosition).Size();
+		return true;
+	}
+
+	void GenerateDirectionalLightOcclusionRayWithLightingData(const FCausticsLight& LightParameters, const FVector& WorldPosition, const FVector2D& RandSample, FCausticsRay& OutRay)
+	{
+		// Draw random variable and choose a point on a unit disk
+		const FVector2D DiskUV = UniformSampleDiskConcentric(RandSample) * LightParameters.SourceRadius;
+
+		// Permute light direction by user-defined radius on unit sphere
+		FVector LightDirection = LightParameters.Direction;
+		const FVector N = LightDirection;
+		FVector dPdu(1.0f, 0.0f, 0.0f);
+		if ((N | dPdu) != 0.0f)
+		{
+			dPdu = N ^ dPdu;
+		}
+		else
+		{
+			dPdu = N ^ FVector(0.0f, 1.0f, 0.0f);
+		}
+		const FVector dPdv = dPdu ^ N;
+		LightDirection += dPdu * DiskUV.X + dPdv * DiskUV.Y;
+
+		OutRay.Origin = WorldPosition;
+		OutRay.Direction = LightDirection.GetSafeNormal();
+		OutRay.TMin = 0.0f;
+		OutRay.TMax = 1.0e27f;
+	}
+
+	bool GenerateSpotLightOcclusionRayWithLightingData(const FCausticsLight& LightParameters, const FVector& WorldPosition, const FVector2D& RandSample, FCausticsRay& OutRay)
+	{
+		bool bIsVisible = true;
+		FVector LightDirection = LightParameters.LightPosition - WorldPosition;
+		const float RayLength = LightDirection.Size();
+		LightDirection /= RayLength;
+
+		if (LightParameters.SourceRadius > 0.0f)
+		{
+			bIsVisible = GenerateDiskLightOcclusionRayWithLightingData(LightParameters, WorldPosition, RandSample, OutRay);
+		}
+		else
+		{
+			OutRay.Origin = WorldPosition;
+			OutRay.Direction = LightDirection;
+			OutRay.TMin = 0.01f;
+			OutRay.TMax = RayLength;
+		}
+
+		// Apply culling
+		if (bIsVisible)
+		{
+			bIsVisible = (LightDirection | LightParameters.Direction) >= LightParameters.SpotAngles.X;
+		}
+		return bIsVisible;
+	}
+}
+
+bool GenerateOcclusionRayWithLightingData(
+	const FCausticsLight& LightingData,
+	const FVector& WorldPosition,
+	const FVector& WorldNormal,
+	const FVector2D& RandSample,
+	FCausticsRay& OutRay)
+{
+	switch (LightingData.Type)
+	{
+	case ECausticsLightType::Directional:
+		GenerateDirectionalLightOcclusionRayWithLightingData(LightingData, WorldPosition, RandSample, OutRay);
+		return true;
+	case ECausticsLightType::Point:
+		if (LightingData.SourceRadius == 0.0f)
+		{
+			return GeneratePointLightOcclusionRayWithLightingData(LightingData, WorldPosition, OutRay);
+		}
+		return GenerateSphereLightOcclusionRayWithLightingData(LightingData, WorldPosition, RandSample, OutRay);
+	case ECausticsLightType::Rect:
+		return GenerateRectLightOcclusionRayWithLightingData(LightingData, WorldPosition, RandSample, OutRay);
+	case ECausticsLightType::Spot:
+		return GenerateSpotLightOcclusionRayWithLightingData(LightingData, WorldPosition, RandSample, OutRay);
+	default:
+		OutRay.Origin = LightingData.LightPosition;
+		OutRay.TMax = 1e27f;
+		OutRay.TMin = 0.01f;
+		OutRay.Direction = LightingData.Direction;
+		return false;
+	}
+}
+
+FVector GetLightIrradiance(const FCausticsLight& Light, const FVector& L, float Distance)
+{
+	if (Light.Type == ECausticsLightType::Directional)
+	{
+		return Light.LightColor;
+	}
+
+	const float DistanceSqr = Distance * Distance;
+	float Falloff = 1.0f / (DistanceSqr + 1.0f);
+	Falloff *= FMath::Square(Saturate(1.0f - FMath::Square(DistanceSqr * FMath::Square(Light.InvRadius))));
+
+	if (Light.Type == ECausticsLightType::Spot)
+	{
+		Falloff *= FMath::Square(Saturate(((L | Light.Direction) - Light.SpotAngles.X) * Light.SpotAngles.Y));
+	}
+	else if (Light.Type == ECausticsLightType::Rect)
+	{
+		Falloff *= Saturate(L | Light.Direction);
+	}
+	return Light.LightColor * Falloff;
+}
+
+bool GenerateEmissionRayWithLightingData(
+	const FCausticsLight& LightingData,
+	const FVector& TargetCenter,
+	float TargetRadius,
+	const FVector2D& CellUV,
+	FCausticsRay& OutRay,
+	float& OutDiskDistance)
+{
+	// Far enough for a directional light to start outside of any caustic casting instance, in cm
+	static const float DirectionalEmissionDistance = 100000.0f;
+
+	const bool bDirectional = LightingData.Type == ECausticsLightType::Directional;
+	FVector EmissionAxis;
+	if (bDirectional)
+	{
+		EmissionAxis = -LightingData.Direction;
+		OutDiskDistance = DirectionalEmissionDistance;
+	}
+	else
+	{
+		const FVector ToTarget = TargetCenter - LightingData.LightPosition;
+		OutDiskDistance = ToTarget.Size();
+		EmissionAxis = ToTarget / OutDiskDistance;
+	}
+
+	const FVector2D DiskUV = UniformSampleDiskConcentric(CellUV) * TargetRadius;
+	const FVector DiskPosition = TargetCenter + TangentToWorld(FVector(DiskUV.X, DiskUV.Y, 0.0f), EmissionAxis);
+
+	OutRay.TMin = 0.01f;
+	if (bDirectional)
+	{
+		OutRay.Origin = DiskPosition - EmissionAxis * DirectionalEmissionDistance;
+		OutRay.Direction = EmissionAxis;
+		OutRay.TMax = 2.0f * DirectionalEmissionDistance;
+	}
+	else
+	{
+		OutRay.Origin = LightingData.LightPosition;
+		OutRay.Direction = (DiskPosition - OutRay.Origin).GetSafeNormal();
+		OutRay.TMax = OutDiskDistance + 2.0f * TargetRadius;
+	}
+
+	// Lights inside of the target would need to emit over the whole sphere
+	return LightingData.Type <= ECausticsLightType::Rect && OutDiskDistance > TargetRadius;
+}
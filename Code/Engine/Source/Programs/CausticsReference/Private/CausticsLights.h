@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CausticsBVH.h"
+
+struct FCausticsLight;
+
+/**
+ * GenerateOcclusionRayWithLightingData() from RayTracingLightsForCaustics.ush.
+ * Returns false when the light cannot reach WorldPosition, the ray is still filled in like on the GPU.
+ */
+bool GenerateOcclusionRayWithLightingData(
+	const FCausticsLight& LightingData,
+	const FVector& WorldPosition,
+	const FVector& WorldNormal,
+	const FVector2D& RandSample,
+	FCausticsRay& OutRay);
+
+/**
+ * Unshadowed radiance reaching WorldPosition from Light along the normalized direction L (surface to light) over Distance,
+ * using the inverse square falloff with attenuation radius window and spot cone of DeferredLightingCommon.ush.
+ */
+FVector GetLightIrradiance(const FCausticsLight& Light, const FVector& L, float Distance);
+
+/**
+ * GenerateEmissionRayWithLightingData() from RayTracingLightsForCaustics.ush.
+ * Emits a ray from the light through the disk covering the bounding sphere of a target, CellUV picks the point on the disk.
+ * OutDiskDistance is the distance from the ray origin to the disk. Returns false for lights inside of the target.
+ */
+bool GenerateEmissionRayWithLightingData(
+	const FCausticsLight& LightingData,
+	const FVector& TargetCenter,
+	float TargetRadius,
+	const FVector2D& CellUV,
+	FCausticsRay& OutRay,
+	float& OutDiskDistance);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * CPU stand-in for RandomSequence from PathTracingRandomSequence.ush.
+ * It keeps the shader's seeding scheme (pixel linear index + View.StateFrameIndex) and call pattern,
+ * so each pixel consumes the same number of samples in the same order, but the values are not bit-exact with the GPU.
+ */
+struct FCausticsRandomSequence
+{
+	uint32 SampleIndex;
+	uint32 SampleSeed;
+};
+
+// StrongIntegerHash() from Random.ush
+FORCEINLINE uint32 StrongIntegerHash(uint32 X)
+{
+	X ^= X >> 16;
+	X *= 0x7feb352du;
+	X ^= X >> 15;
+	X *= 0x846ca68bu;
+	X ^= X >> 16;
+	return X;
+}
+
+FORCEINLINE void RandomSequence_Initialize(FCausticsRandomSequence& RandSequence, uint32 PositionSeed, uint32 TimeSeed)
+{
+	RandSequence.SampleIndex = 0;
+	RandSequence.SampleSeed = StrongIntegerHash(PositionSeed ^ StrongIntegerHash(TimeSeed));
+}
+
+FORCEINLINE float RandomSequence_GenerateSample1D(FCausticsRandomSequence& RandSequence)
+{
+	const uint32 Bits = StrongIntegerHash(RandSequence.SampleSeed ^ StrongIntegerHash(RandSequence.SampleIndex++));
+	return float(Bits >> 8) * (1.0f / 16777216.0f);
+}
+
+FORCEINLINE FVector2D RandomSequence_GenerateSample2D(FCausticsRandomSequence& RandSequence)
+{
+	const float U = RandomSequence_GenerateSample1D(RandSequence);
+	const float V = RandomSequence_GenerateSample1D(RandSequence);
+	return FVector2D(U, V);
+}
@@ -0,0 +1,202 @@
+#include "CausticsReference.h"
+#include "CausticsBVH.h"
+#include "CausticsDenoiser.h"
+#include "CausticsImage.h"
+#include "CausticsRenderer.h"
+#include "CausticsScene.h"
+#include "CausticsView.h"
+
+#include "RequiredProgramMainCPPInclude.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY(LogCausticsReference);
+
+IMPLEMENT_APPLICATION(CausticsReference, "CausticsReference");
+
+namespace
+{
+	void PrintUsage()
+	{
+		UE_LOG(LogCausticsReference, Display, TEXT("Usage: CausticsReference -scene=<file> [-out=<prefix>] [-width=1280] [-height=720] [-frame=0]"));
+		UE_LOG(LogCausticsReference, Display, TEXT("       [-spp=1] [-upscale=1] [-maxrefraction=3] [-shadows=1] [-accumulationscale=1024]"));
+		UE_LOG(LogCausticsReference, Display, TEXT("       [-lightspace] [-lightspaceresolution=256] [-nolightculling] [-lightsamples=0]"));
+		UE_LOG(LogCausticsReference, Display, TEXT("       [-wavefront] [-wavefrontqueueitems=1]"));
+		UE_LOG(LogCausticsReference, Display, TEXT("       [-denoise] [-denoiseriterations=3] [-denoiserluminancesigma=0.5]"));
+		UE_LOG(LogCausticsReference, Display, TEXT("       [-singlethread] [-nopackets]"));
+		UE_LOG(LogCausticsReference, Display, TEXT("       CausticsReference -test[=CausticsReference]"));
+	}
+
+	/** Runs the automation tests whose name starts with Filter, see Private/Tests. Returns whether any ran and all passed. */
+	bool RunTests(const FString& Filter)
+	{
+		FAutomationTestFramework& Framework = FAutomationTestFramework::Get();
+		TArray<FAutomationTestInfo> TestInfos;
+		Framework.GetValidTestNames(TestInfos);
+
+		int32 NumTests = 0;
+		int32 NumFailed = 0;
+		for (const FAutomationTestInfo& TestInfo : TestInfos)
+		{
+			if (!TestInfo.GetDisplayName().StartsWith(Filter))
+			{
+				continue;
+			}
+
+			Framework.StartTestByName(TestInfo.GetTestName(), 0);
+			FAutomationTestExecutionInfo ExecutionInfo;
+			const bool bPassed = Framework.StopTest(ExecutionInfo);
+			for (const FAutomationExecutionEntry& Entry : ExecutionInfo.GetEntries())
+			{
+				if (Entry.Event.Type == EAutomationEventType::Error)
+				{
+					UE_LOG(LogCausticsReference, Error, TEXT("  %s"), *Entry.Event.Message);
+				}
+			}
+			UE_LOG(LogCausticsReference, Display, TEXT("%s %s"), bPassed ? TEXT("Passed") : TEXT("Failed"), *TestInfo.GetDisplayName());
+
+			++NumTests;
+			NumFailed += bPassed ? 0 : 1;
+		}
+
+		UE_LOG(LogCausticsReference, Display, TEXT("%d of %d tests passed"), NumTests - NumFailed, NumTests);
+		return NumTests > 0 && NumFailed == 0;
+	}
+}
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	GEngineLoop.PreInit(ArgC, ArgV);
+
+	const TCHAR* CmdLine = FCommandLine::Get();
+
+	FString TestFilter = TEXT("CausticsReference");
+	if (FParse::Value(CmdLine, TEXT("-test="), TestFilter) || FParse::Param(CmdLine, TEXT("test")))
+	{
+		const bool bPassed = RunTests(TestFilter);
+		FEngineLoop::AppExit();
+		return bPassed ? 0 : 1;
+	}
+
+	FString SceneFilename;
+	if (!FParse::Value(CmdLine, TEXT("-scene="), SceneFilename))
+	{
+		PrintUsage();
+		FEngineLoop::AppExit();
+		return 1;
+	}
+
+	FString OutputPrefix = TEXT("Caustics");
+	FParse::Value(CmdLine, TEXT("-out="), OutputPrefix);
+
+	FIntPoint BufferSize(1280, 720);
+	FParse::Value(CmdLine, TEXT("-width="), BufferSize.X);
+	FParse::Value(CmdLine, TEXT("-height="), BufferSize.Y);
+
+	uint32 StateFrameIndex = 0;
+	FParse::Value(CmdLine, TEXT("-frame="), StateFrameIndex);
+
+	FCausticsParameters Parameters;
+	FParse::Value(CmdLine, TEXT("-spp="), Parameters.SamplesPerPixel);
+	FParse::Value(CmdLine, TEXT("-upscale="), Parameters.UpscaleFactor);
+	FParse::Value(CmdLine, TEXT("-maxrefraction="), Parameters.MaxRefractionRays);
+	FParse::Value(CmdLine, TEXT("-shadows="), Parameters.ReflectedShadowsType);
+	FParse::Value(CmdLine, TEXT("-accumulationscale="), Parameters.ColorAccumulationScale);
+	FParse::Value(CmdLine, TEXT("-lightspaceresolution="), Parameters.LightSpaceResolution);
+	Parameters.bLightSpaceEmission = FParse::Param(CmdLine, TEXT("lightspace"));
+	Parameters.bLightCulling = !FParse::Param(CmdLine, TEXT("nolightculling"));
+	FParse::Value(CmdLine, TEXT("-lightsamples="), Parameters.LightSamplesPerPixel);
+	Parameters.bWavefront = FParse::Param(CmdLine, TEXT("wavefront"));
+	FParse::Value(CmdLine, TEXT("-wavefrontqueueitems="), Parameters.WavefrontQueueItemsPerPixel);
+
+	FCausticsDenoiserParameters DenoiserParameters;
+	const bool bDenoise = FParse::Param(CmdLine, TEXT("denoise"));
+	FParse::Value(CmdLine, TEXT("-denoiseriterations="), DenoiserParameters.Iterations);
+	FParse::Value(CmdLine, TEXT("-denoiserluminancesigma="), DenoiserParameters.LuminanceSigma);
+	DenoiserParameters.Iterations = FMath::Clamp(DenoiserParameters.Iterations, 0, 8);
+
+	FCausticsRenderOptions Options;
+	Options.bForceSingleThread = FParse::Param(CmdLine, TEXT("singlethread"));
+	Options.bPrimaryRayPackets = !FParse::Param(CmdLine, TEXT("nopackets"));
+
+	if (BufferSize.X <= 0 || BufferSize.Y <= 0 || Parameters.UpscaleFactor < 1 || !FMath::IsPowerOfTwo(Parameters.UpscaleFactor))
+	{
+		UE_LOG(LogCausticsReference, Error, TEXT("Invalid resolution or upscale factor, the upscale factor must be a power of two."));
+		FEngineLoop::AppExit();
+		return 1;
+	}
+
+	FCausticsScene Scene;
+	if (!Scene.LoadFromFile(*SceneFilename))
+	{
+		FEngineLoop::AppExit();
+		return 1;
+	}
+
+	const double BuildStartTime = FPlatformTime::Seconds();
+	FCausticsBVH BVH;
+	BVH.Build(Scene);
+	UE_LOG(LogCausticsReference, Display, TEXT("Built BVH with %d nodes in %.1f ms"), BVH.NumNodes(), (FPlatformTime::Seconds() - BuildStartTime) * 1000.0);
+
+	FCausticsView View;
+	View.Init(Scene.Camera, BufferSize, StateFrameIndex);
+
+	const FCausticsRenderer Renderer(Scene, BVH, View, Parameters);
+	FCausticsOutput Output;
+
+	const double RenderStartTime = FPlatformTime::Seconds();
+	Renderer.Render(Output, Options);
+	const double RenderTime = FPlatformTime::Seconds() - RenderStartTime;
+
+	const uint64 TotalRays = Output.Stats.GetTotal();
+	UE_LOG(LogCausticsReference, Display, TEXT("Dispatch %dx%d: %llu rays in %.1f ms (%.2f Mrays/s, %.2f rays per thread)"),
+		Output.DispatchSize.X, Output.DispatchSize.Y, TotalRays, RenderTime * 1000.0, TotalRays / FMath::Max(RenderTime, 1e-6) * 1e-6,
+		double(TotalRays) / FMath::Max(Output.DispatchSize.X * Output.DispatchSize.Y, 1));
+	for (int32 RayType = 0; RayType < ECausticsRayType::Num; ++RayType)
+	{
+		UE_LOG(LogCausticsReference, Display, TEXT("  %-22s %llu"), GetCausticsRayTypeName(ECausticsRayType::Type(RayType)), Output.Stats.NumRays[RayType]);
+	}
+	if (Output.bWavefront)
+	{
+		for (int32 Stage = 0; Stage < ECausticsWavefrontStage::Num; ++Stage)
+		{
+			const FCausticsWavefrontStageStats& StageStats = Output.WavefrontStats[Stage];
+			UE_LOG(LogCausticsReference, Display, TEXT("  %-9s stage: %lld of %lld threads live (%.1f%%), %llu rays, %lld appended, %lld dropped"),
+				GetCausticsWavefrontStageName(ECausticsWavefrontStage::Type(Stage)), StageStats.NumLiveThreads, StageStats.NumThreads,
+				100.0 * StageStats.NumLiveThreads / FMath::Max<int64>(StageStats.NumThreads, 1), StageStats.NumRays, StageStats.NumAppended, StageStats.NumDropped);
+		}
+	}
+
+	TArray<float> RayCounts;
+	RayCounts.SetNumUninitialized(Output.RayCounts.Num());
+	for (int32 Index = 0; Index < RayCounts.Num(); ++Index)
+	{
+		RayCounts[Index] = float(Output.RayCounts[Index]);
+	}
+
+	bool bWritten = WriteColorPFM(*(OutputPrefix + TEXT("Color.pfm")), Output.Size, Output.Color)
+		&& WriteGrayscalePFM(*(OutputPrefix + TEXT("HitDistance.pfm")), Output.Size, Output.RayHitDistance)
+		&& WriteGrayscalePFM(*(OutputPrefix + TEXT("ImaginaryDepth.pfm")), Output.Size, Output.RayImaginaryDepth)
+		&& WriteGrayscalePFM(*(OutputPrefix + TEXT("RayCounts.pfm")), Output.DispatchSize, RayCounts);
+
+	if (bWritten && bDenoise)
+	{
+		const double DenoiseStartTime = FPlatformTime::Seconds();
+		TArray<FVector4> DenoiserGuide;
+		Renderer.RenderDenoiserGuide(DenoiserGuide, Options);
+		TArray<FLinearColor> DenoisedColor = Output.Color;
+		DenoiseCaustics(DenoiserParameters, Output.Size, DenoiserGuide, DenoisedColor, Options.bForceSingleThread);
+		UE_LOG(LogCausticsReference, Display, TEXT("Denoised with %d iterations in %.1f ms"), DenoiserParameters.Iterations, (FPlatformTime::Seconds() - DenoiseStartTime) * 1000.0);
+
+		bWritten = WriteColorPFM(*(OutputPrefix + TEXT("ColorDenoised.pfm")), Output.Size, DenoisedColor);
+	}
+	if (!bWritten)
+	{
+		UE_LOG(LogCausticsReference, Error, TEXT("Failed to write outputs with prefix %s"), *OutputPrefix);
+	}
+
+	FEngineLoop::AppExit();
+	return bWritten ? 0 : 1;
+}
@@ -0,0 +1,1060 @@
+#include "CausticsRenderer.h"
+#include "CausticsLightCulling.h"
+#include "CausticsLightSampling.h"
+#include "CausticsLights.h"
+#include "CausticsScene.h"
+#include "CausticsShaderMath.h"
+#include "CausticsView.h"
+#include "Async/ParallelFor.h"
+
+// Mirrors ERayTracingPrimaryRaysFlag in RayTracingCaustics.usf
+#define ERayTracingPrimaryRaysFlag_AllowSkipSkySample (1u << 2)
+
+namespace
+{
+	void WriteClampedDistance(TArray<float>& Texture, FIntPoint Size, FIntPoint Coord, float Distance, float MinDistance, float MaxDistance)
+	{
+		// Out of bounds UAV writes are dropped
+		if (Distance > 0.0f && Coord.X < Size.X && Coord.Y < Size.Y)
+		{
+			Texture[Coord.Y * Size.X + Coord.X] = FMath::Clamp(Distance, MinDistance, MaxDistance);
+		}
+	}
+
+	float GetDielectricIor(float Specular)
+	{
+		return DielectricF0ToIor(DielectricSpecularToF0(Specular));
+	}
+
+	/** CAUSTICS_RECEIVER_VISIBILITY_TOLERANCE */
+	const float CausticsReceiverVisibilityTolerance = 1.5f;
+
+	/** Queue items a worker takes at once in the wavefront stages past the first. */
+	const int32 CausticsWavefrontChunkSize = 1024;
+
+	/** Threads the GPU dispatches for a queue, whole rows of the dispatch covering its capacity. */
+	int64 GetCausticsWavefrontStageThreads(int32 Capacity, int32 DispatchWidth)
+	{
+		return int64(FMath::DivideAndRoundUp(Capacity, DispatchWidth)) * DispatchWidth;
+	}
+}
+
+const TCHAR* GetCausticsRayTypeName(ECausticsRayType::Type RayType)
+{
+	switch (RayType)
+	{
+	case ECausticsRayType::Primary:					return TEXT("Primary");
+	case ECausticsRayType::Occlusion:				return TEXT("Occlusion");
+	case ECausticsRayType::TranslucentOcclusion:	return TEXT("TranslucentOcclusion");
+	case ECausticsRayType::Probe:					return TEXT("Probe");
+	case ECausticsRayType::Incident:				return TEXT("Incident");
+	case ECausticsRayType::IncidentShadow:			return TEXT("IncidentShadow");
+	case ECausticsRayType::Absorption:				return TEXT("Absorption");
+	case ECausticsRayType::Transmission:			return TEXT("Transmission");
+	case ECausticsRayType::DepthCheck:				return TEXT("DepthCheck");
+	case ECausticsRayType::Emission:				return TEXT("Emission");
+	default:										return TEXT("Unknown");
+	}
+}
+
+uint64 FCausticsRayStats::GetTotal() const
+{
+	uint64 Total = 0;
+	for (uint64 Count : NumRays)
+	{
+		Total += Count;
+	}
+	return Total;
+}
+
+void FCausticsRayStats::Accumulate(const FCausticsRayStats& Other)
+{
+	for (int32 RayType = 0; RayType < ECausticsRayType::Num; ++RayType)
+	{
+		NumRays[RayType] += Other.NumRays[RayType];
+	}
+}
+
+FCausticsRenderer::FCausticsRenderer(const FCausticsScene& InScene, const FCausticsBVH& InBVH, const FCausticsView& InView, const FCausticsParameters& InParameters)
+	: Scene(InScene)
+	, BVH(InBVH)
+	, View(InView)
+	, Parameters(InParameters)
+{
+	check(Parameters.UpscaleFactor >= 1 && FMath::IsPowerOfTwo(Parameters.UpscaleFactor));
+	Parameters.ColorAccumulationScale = FMath::Max(Parameters.ColorAccumulationScale, 1.0f);
+	Parameters.LightSpaceResolution = FMath::Clamp(Parameters.LightSpaceResolution, 1, 4096);
+	Parameters.LightSamplesPerPixel = Parameters.bLightSpaceEmission ? 0 : FMath::Max(Parameters.LightSamplesPerPixel, 0);
+
+	// Light culling only applies to the screen mode
+	Parameters.bLightCulling = Parameters.bLightCulling && !Parameters.bLightSpaceEmission;
+	Parameters.bWavefront = Parameters.bWavefront && !Parameters.bLightSpaceEmission;
+	Parameters.WavefrontQueueItemsPerPixel = FMath::Max(Parameters.WavefrontQueueItemsPerPixel, 0.0f);
+
+	if (Parameters.bLightSpaceEmission || Parameters.bLightCulling)
+	{
+		Scene.GetTranslucentInstanceBounds(EmitterTargets);
+	}
+}
+
+FIntPoint FCausticsRenderer::GetDispatchSize() const
+{
+	return FIntPoint::DivideAndRoundUp(View.BufferSize, Parameters.UpscaleFactor);
+}
+
+FIntPoint FCausticsRenderer::GetLightSpaceDispatchSize() const
+{
+	return FIntPoint(Parameters.LightSpaceResolution, Parameters.LightSpaceResolution * EmitterTargets.Num());
+}
+
+void FCausticsRenderer::Render(FCausticsOutput& Output, const FCausticsRenderOptions& Options) const
+{
+	Output.Size = GetDispatchSize();
+	Output.DispatchSize = Parameters.bLightSpaceEmission ? GetLightSpaceDispatchSize() : Output.Size;
+	const int32 NumThreads = Output.Size.X * Output.Size.Y;
+	Output.ColorAccumulation.Init(0, NumThreads * CausticsAccumulationChannels);
+	Output.RayHitDistance.Init(0.0f, NumThreads);
+	Output.RayImaginaryDepth.Init(0.0f, NumThreads);
+	Output.RayCounts.Init(0, Output.DispatchSize.X * Output.DispatchSize.Y);
+	Output.Stats = FCausticsRayStats();
+	Output.bWavefront = Parameters.bWavefront;
+	for (FCausticsWavefrontStageStats& StageStats : Output.WavefrontStats)
+	{
+		StageStats = FCausticsWavefrontStageStats();
+	}
+
+	TArray<FThreadContext> RowContexts;
+	RowContexts.SetNum(Output.DispatchSize.Y);
+
+	if (Parameters.bLightSpaceEmission)
+	{
+		ParallelFor(Output.DispatchSize.Y, [this, &Output, &RowContexts](int32 DispatchY)
+		{
+			FThreadContext& Context = RowContexts[DispatchY];
+			for (int32 DispatchX = 0; DispatchX < Output.DispatchSize.X; ++DispatchX)
+			{
+				const uint64 NumRaysBefore = Context.Stats.GetTotal();
+				LightSpaceRayGen(FIntPoint(DispatchX, DispatchY), Context);
+				Output.RayCounts[DispatchY * Output.DispatchSize.X + DispatchX] = uint32(Context.Stats.GetTotal() - NumRaysBefore);
+			}
+		}, Options.bForceSingleThread);
+	}
+	else
+	{
+		// RayTracingCausticsLightCullingCS runs before the caustics dispatch, an empty culling visits every light
+		FCausticsLightCulling LightCulling;
+		if (Parameters.bLightCulling)
+		{
+			LightCulling.Build(View, Parameters.UpscaleFactor, Output.DispatchSize, Scene.Lights, EmitterTargets, Options.bForceSingleThread);
+		}
+
+		// BuildCausticsLightAliasTable() of RayTracingCaustics.cpp
+		TArray<FCausticsLightAliasEntry> LightAliasTable;
+		if (Parameters.LightSamplesPerPixel > 0)
+		{
+			TArray<float> LightWeights;
+			for (const FCausticsLight& Light : Scene.Lights)
+			{
+				LightWeights.Add(GetCausticsLightSelectionWeight(Light, View.WorldCameraOrigin));
+			}
+			BuildCausticsLightAliasTable(LightWeights, LightAliasTable);
+		}
+
+		if (Parameters.bWavefront)
+		{
+			RenderWavefront(Output, Options, LightCulling, LightAliasTable, RowContexts);
+		}
+		else
+		{
+			ParallelFor(Output.DispatchSize.Y, [this, &Output, &RowContexts, &Options, &LightCulling, &LightAliasTable](int32 DispatchY)
+			{
+				FThreadContext& Context = RowContexts[DispatchY];
+
+				// Matches the early out at the top of the shader, before any ray is traced
+				if (Parameters.MaxRefractionRays <= 2)
+				{
+					return;
+				}
+
+				TArray<FCausticsRay> PrimaryRays;
+				TArray<FCausticsHit> PrimaryHits;
+				TracePrimaryRays(DispatchY, Output.DispatchSize.X, Options, PrimaryRays, PrimaryHits);
+
+					for (int32 DispatchX = 0; DispatchX < Output.DispatchSize.X; ++DispatchX)
+				{
+					const uint64 NumRaysBefore = Context.Stats.GetTotal();
+					Context.Stats.NumRays[ECausticsRayType::Primary]++;
+					RayGen(FIntPoint(DispatchX, DispatchY), PrimaryRays[DispatchX], PrimaryHits[DispatchX], LightCulling, LightAliasTable, Context);
+					Output.RayCounts[DispatchY * Output.DispatchSize.X + DispatchX] = uint32(Context.Stats.GetTotal() - NumRaysBefore);
+				}
+			}, Options.bForceSingleThread);
+		}
+	}
+
+	for (const FThreadContext& Context : RowContexts)
+	{
+		Output.Stats.Accumulate(Context.Stats);
+		for (const FSplat& Splat : Context.Splats)
+		{
+			ApplySplat(Splat, Output);
+		}
+	}
+
+	ResolveCausticsAccumulation(Output.ColorAccumulation, Output.Size, Parameters.ColorAccumulationScale, Output.Color);
+}
+
+void FCausticsRenderer::RenderDenoiserGuide(TArray<FVector4>& OutGuide, const FCausticsRenderOptions& Options) const
+{
+	const FIntPoint Size = GetDispatchSize();
+	OutGuide.Init(FVector4(0.0f, 0.0f, 0.0f, 0.0f), Size.X * Size.Y);
+
+	ParallelFor(Size.Y, [this, &OutGuide, Size](int32 Y)
+	{
+		for (int32 X = 0; X < Size.X; ++X)
+		{
+			const FCausticsRay Ray = CreatePrimaryRay(FIntPoint(X, Y));
+			FCausticsHit Hit;
+			if (BVH.TraceRay(Ray, ECausticsRayFlags::None, ECausticsInstanceMask::Opaque, Hit))
+			{
+				const FCausticsMaterialPayload Payload = GetMaterialPayload(Hit);
+				OutGuide[Y * Size.X + X] = FVector4(Payload.WorldNormal, Hit.T * (Ray.Direction | View.ViewForward));
+			}
+		}
+	}, Options.bForceSingleThread);
+}
+
+void FCausticsRenderer::ApplySplat(const FSplat& Splat, FCausticsOutput& Output) const
+{
+	AccumulateCausticsColor(Output.ColorAccumulation, Output.Size, Parameters.ColorAccumulationScale, Splat.ThreadId, Splat.Color);
+
+	WriteClampedDistance(Output.RayHitDistance, Output.Size, Splat.ThreadId, Splat.TransmissionHitT, 200.0f, 1000.0f);
+	WriteClampedDistance(Output.RayImaginaryDepth, Output.Size, Splat.ThreadId, Splat.ImaginaryDepth, 50.0f, 1000.0f);
+}
+
+FCausticsMaterialPayload FCausticsRenderer::TraceMaterialRay(const FCausticsRay& Ray, uint32 RayFlags, uint32 InstanceInclusionMask, ECausticsRayType::Type RayType, FThreadContext& Context) const
+{
+	Context.Stats.NumRays[RayType]++;
+
+	FCausticsHit Hit;
+	BVH.TraceRay(Ray, RayFlags, InstanceInclusionMask, Hit);
+	return GetMaterialPayload(Hit);
+}
+
+FCausticsVisibilityPayload FCausticsRenderer::TraceVisibilityRay(const FCausticsRay& Ray, uint32 RayFlags, uint32 InstanceInclusionMask, ECausticsRayType::Type RayType, FThreadContext& Context) const
+{
+	Context.Stats.NumRays[RayType]++;
+
+	FCausticsHit Hit;
+	FCausticsVisibilityPayload Payload;
+	if (BVH.TraceRay(Ray, RayFlags, InstanceInclusionMask, Hit))
+	{
+		Payload.HitT = Hit.T;
+	}
+	return Payload;
+}
+
+FCausticsMaterialPayload FCausticsRenderer::GetMaterialPayload(const FCausticsHit& Hit) const
+{
+	FCausticsMaterialPayload Payload;
+	if (!Hit.IsHit())
+	{
+		return Payload;
+	}
+
+	const FCausticsMaterial& Material = Scene.GetTriangleMaterial(Hit.TriangleIndex);
+	FVector V0, V1, V2;
+	Scene.GetTriangle(Hit.TriangleIndex, V0, V1, V2);
+
+	Payload.HitT = Hit.T;
+	Payload.WorldNormal = ((V1 - V0) ^ (V2 - V0)).GetSafeNormal();
+	Payload.Radiance = Material.Emissive;
+	Payload.BaseColor = Material.BaseColor;
+	Payload.DiffuseColor = Material.BaseColor;
+	Payload.Opacity = Material.BlendingMode == ECausticsBlendMode::Opaque ? 1.0f : Material.Opacity;
+	Payload.Roughness = Material.Roughness;
+	Payload.Specular = Material.Specular;
+	Payload.Ior = Material.AbsorptionCoefficient;
+	Payload.BlendingMode = Material.BlendingMode;
+	Payload.bFrontFace = Hit.bFrontFace;
+	return Payload;
+}
+
+FCausticsMaterialPayload FCausticsRenderer::TraceRayAndAccumulateResults(
+	const FCausticsRay& Ray,
+	uint32 RayFlags,
+	uint32 InstanceInclusionMask,
+	FCausticsRandomSequence& RandSequence,
+	FVector& OutRadiance,
+	FThreadContext& Context) const
+{
+	const FCausticsMaterialPayload Payload = TraceMaterialRay(Ray, RayFlags, InstanceInclusionMask, ECausticsRayType::Incident, Context);
+	if (Payload.IsMiss())
+	{
+		return Payload;
+	}
+
+	if (Parameters.ShouldDoEmissiveAndIndirectLighting)
+	{
+		OutRadiance += Payload.Radiance;
+	}
+
+	if (Parameters.ShouldDoDirectLighting)
+	{
+		const FVector HitPosition = Ray.Origin + Ray.Direction * Payload.HitT;
+		const FVector FacingNormal = (Payload.WorldNormal | Ray.Direction) > 0.0f ? -Payload.WorldNormal : Payload.WorldNormal;
+		const FVector ShadowOrigin = HitPosition + FacingNormal * Parameters.MaxNormalBias;
+
+		for (const FCausticsLight& Light : Scene.Lights)
+		{
+			// Hard shadows use the light center, area shadows a random point on the source
+			const FVector2D LightSample = Parameters.ReflectedShadowsType == 2 ? RandomSequence_GenerateSample2D(RandSequence) : FVector2D(0.5f, 0.5f);
+
+			FCausticsRay ShadowRay;
+			if (!GenerateOcclusionRayWithLightingData(Light, ShadowOrigin, FacingNormal, LightSample, ShadowRay))
+			{
+				continue;
+			}
+
+			const float NoL = FacingNormal | ShadowRay.Direction;
+			if (NoL <= 0.0f)
+			{
+				continue;
+			}
+
+			if (Parameters.ReflectedShadowsType > 0)
+			{
+				Context.Stats.NumRays[ECausticsRayType::IncidentShadow]++;
+				FCausticsHit ShadowHit;
+				if (BVH.TraceRay(ShadowRay, ECausticsRayFlags::AcceptFirstHitAndEndSearch, ECausticsInstanceMask::Shadow, ShadowHit))
+				{
+					continue;
+				}
+			}
+
+			OutRadiance += Payload.DiffuseColor * (GetLightIrradiance(Light, ShadowRay.Direction, ShadowRay.TMax) * (NoL / PI));
+		}
+	}
+	return Payload;
+}
+
+// check the P_f is visible from the current camera
+bool FCausticsRenderer::CheckDepthAvalible(const FVector2D& UV, const FVector& WorldPosition, float& OutImaginaryDepth, FThreadContext& Context) const
+{
+	OutImaginaryDepth = 0.0f;
+
+	// The closest opaque hit stands in for the depth buffer, which the shader reads without tracing
+	FCausticsRay Ray = View.CreatePrimaryRay(UV);
+	FCausticsHit SceneHit;
+	if (!BVH.TraceRay(Ray, ECausticsRayFlags::None, ECausticsInstanceMask::Opaque, SceneHit))
+	{
+		return false;
+	}
+
+	const FVector SceneWorldPosition = Ray.Origin + Ray.Direction * SceneHit.T;
+	if ((WorldPosition - SceneWorldPosition).Size() > CausticsReceiverVisibilityTolerance)
+	{
+		return false;
+	}
+
+	Ray.TMax = SceneHit.T - CausticsReceiverVisibilityTolerance;
+	if (Ray.TMax > Ray.TMin)
+	{
+		const FCausticsVisibilityPayload Payload = TraceVisibilityRay(Ray, ECausticsRayFlags::AcceptFirstHitAndEndSearch, ECausticsInstanceMask::Translucent, ECausticsRayType::DepthCheck, Context);
+		if (Payload.IsHit())
+		{
+			return false;
+		}
+	}
+
+	OutImaginaryDepth = SceneHit.T;
+	return true;
+}
+
+FCausticsRay FCausticsRenderer::CreatePrimaryRay(FIntPoint DispatchThreadId) const
+{
+	const FIntPoint PixelCoord = View.GetPixelCoord(DispatchThreadId, Parameters.UpscaleFactor);
+	const FVector2D InvBufferSize = View.GetInvBufferSize();
+	const FVector2D UV((PixelCoord.X + 0.5f) * InvBufferSize.X, (PixelCoord.Y + 0.5f) * InvBufferSize.Y);
+	return View.CreatePrimaryRay(UV);
+}
+
+void FCausticsRenderer::TracePrimaryRays(int32 DispatchY, int32 DispatchWidth, const FCausticsRenderOptions& Options, TArray<FCausticsRay>& OutRays, TArray<FCausticsHit>& OutHits) const
+{
+	OutRays.SetNumUninitialized(DispatchWidth);
+	OutHits.SetNumUninitialized(DispatchWidth);
+	for (int32 DispatchX = 0; DispatchX < DispatchWidth; ++DispatchX)
+	{
+		OutRays[DispatchX] = CreatePrimaryRay(FIntPoint(DispatchX, DispatchY));
+	}
+
+	const uint32 PrimaryRayFlags = ECausticsRayFlags::CullBackFacingTriangles;
+	if (Options.bPrimaryRayPackets)
+	{
+		BVH.TraceRays(OutRays, PrimaryRayFlags, ECausticsInstanceMask::All, OutHits);
+	}
+	else
+	{
+		for (int32 DispatchX = 0; DispatchX < DispatchWidth; ++DispatchX)
+		{
+			BVH.TraceRay(OutRays[DispatchX], PrimaryRayFlags, ECausticsInstanceMask::All, OutHits[DispatchX]);
+		}
+	}
+}
+
+float FCausticsRenderer::GetProbeMaxRayDistance(float Roughness) const
+{
+	bool bAllowSkySampling;
+	if ((ERayTracingPrimaryRaysFlag_AllowSkipSkySample & Parameters.PrimaryRayFlags) != 0)
+	{
+		// Sky is only sampled when infinite reflection rays are used.
+		bAllowSkySampling = Parameters.TransmissionMaxRayDistance < 0;
+	}
+	else
+	{
+		bAllowSkySampling = true;
+	}
+	return bAllowSkySampling ? 1e27f : FMath::Lerp(Parameters.TransmissionMaxRayDistance, Parameters.TransmissionMinRayDistance, Roughness);
+}
+
+void FCausticsRenderer::RayGen(
+	FIntPoint DispatchThreadId,
+	const FCausticsRay& Ray,
+	const FCausticsHit& PrimaryHit,
+	const FCausticsLightCulling& LightCulling,
+	const TArray<FCausticsLightAliasEntry>& LightAliasTable,
+	FThreadContext& Context) const
+{
+	const int32 UpscaleFactor = Parameters.UpscaleFactor;
+	const FIntPoint PixelCoord = View.GetPixelCoord(DispatchThreadId, UpscaleFactor);
+	const uint32 LinearIndex = PixelCoord.Y * View.BufferSize.X + PixelCoord.X;
+
+	FCausticsRandomSequence RandSequence;
+	RandomSequence_Initialize(RandSequence, LinearIndex, View.StateFrameIndex);
+
+	uint32 RayFlags = 0;
+	RayFlags |= ECausticsRayFlags::CullBackFacingTriangles;
+
+	// Transmission results are only enabled on the front faces of OPAQUE objects now
+	const FCausticsMaterialPayload Payload = GetMaterialPayload(PrimaryHit);
+
+	// The primary hit stands in for the GBuffer roughness
+	const float LocalMaxRayDistance = GetProbeMaxRayDistance(Payload.Roughness);
+
+	const FVector OcclusionPosition = Ray.Origin + Ray.Direction * Payload.HitT;
+	if (!Payload.IsHit())
+	{
+		return;
+	}
+
+	// Only the lights that can reach the hit through a translucent instance, or a few of them drawn at random
+	const int32 LightCullingCluster = LightCulling.GetCluster(View, DispatchThreadId, OcclusionPosition);
+	for (FCausticsLightLoop LightLoop(LightCulling, LightAliasTable, Parameters.LightSamplesPerPixel, LightCullingCluster, Scene.Lights.Num(), RandSequence); !LightLoop.IsDone(); LightLoop.Advance(RandSequence))
+	{
+		const FCausticsLight& Light = Scene.Lights[LightLoop.LightIndex];
+		if (LightLoop.LightWeight <= 0.0f || Light.Type > ECausticsLightType::Rect)
+		{
+			continue;
+		}
+
+		FVector IncidentRadiance(0.0f, 0.0f, 0.0f);
+		const FVector2D RandSample = RandomSequence_GenerateSample2D(RandSequence);
+
+		FCausticsRay OcclusionRay;
+		const bool bNeedTransmission = GenerateOcclusionRayWithLightingData(Light, OcclusionPosition, Payload.WorldNormal, RandSample, OcclusionRay);
+		if (!bNeedTransmission)
+		{
+			continue;
+		}
+
+		// Only opaque instances are under the mask, any of them in between shadows the light
+		FCausticsVisibilityPayload OcclusionPayload = TraceVisibilityRay(OcclusionRay, RayFlags | ECausticsRayFlags::AcceptFirstHitAndEndSearch, ECausticsInstanceMask::Opaque, ECausticsRayType::Occlusion, Context);
+		if (OcclusionPayload.IsHit())
+		{
+			continue;
+		}
+
+		// Trace the second Occlusion Ray, towards the translucent instance the light goes through
+		OcclusionPayload = TraceVisibilityRay(OcclusionRay, RayFlags, ECausticsInstanceMask::Translucent, ECausticsRayType::TranslucentOcclusion, Context);
+		if (OcclusionPayload.IsMiss())
+		{
+			continue;
+		}
+
+		RayFlags = 0;
+		FCausticsRay ProbeRay;
+		ProbeRay.Origin = OcclusionRay.Origin + OcclusionRay.Direction * OcclusionPayload.HitT;
+		ProbeRay.Direction = OcclusionRay.Direction;
+		ProbeRay.TMax = LocalMaxRayDistance;
+		ProbeRay.TMin = 0.1f;
+
+		FCausticsMaterialPayload ProbePayload = TraceMaterialRay(ProbeRay, RayFlags, ECausticsInstanceMask::Translucent, ECausticsRayType::Probe, Context);
+		if (ProbePayload.IsFrontFace())
+		{
+			continue;
+		}
+
+		{
+			FCausticsRay IncidentRay;
+			IncidentRay.Origin = ProbeRay.Origin + ProbeRay.Direction * (ProbePayload.HitT + 50.0f);
+			IncidentRay.Direction = -ProbeRay.Direction;
+			IncidentRay.TMax = LocalMaxRayDistance;
+			IncidentRay.TMin = 0.1f;
+
+			const FCausticsMaterialPayload IncidentPayload = TraceRayAndAccumulateResults(
+				IncidentRay,
+				ECausticsRayFlags::CullBackFacingTriangles,
+				ECausticsInstanceMask::All,
+				RandSequence,
+				IncidentRadiance,
+				Context);
+
+			IncidentRadiance *= (1.0f - IncidentPayload.Opacity);
+		}
+
+		IncidentRadiance *= LightLoop.LightWeight;
+
+		// Trace the light half path
+		const FVector AbsorptionOrigin = ProbeRay.Origin + ProbeRay.Direction * ProbePayload.HitT;
+		TraceLightHalfPath(RandSequence, AbsorptionOrigin, -ProbeRay.Direction, OcclusionRay.TMax, ProbePayload, IncidentRadiance, 0.0f, RayFlags, Context);
+	}
+}
+
+void FCausticsRenderer::RenderWavefront(
+	FCausticsOutput& Output,
+	const FCausticsRenderOptions& Options,
+	const FCausticsLightCulling& LightCulling,
+	const TArray<FCausticsLightAliasEntry>& LightAliasTable,
+	TArray<FThreadContext>& OutContexts) const
+{
+	const int32 DispatchWidth = Output.DispatchSize.X;
+	const int32 NumDispatchThreads = Output.DispatchSize.X * Output.DispatchSize.Y;
+	const int32 QueueCapacity = FMath::Max(FMath::CeilToInt(NumDispatchThreads * Parameters.WavefrontQueueItemsPerPixel), 1);
+	const int32 ReceiverQueueCapacity = QueueCapacity * FMath::Max(Parameters.SamplesPerPixel, 1);
+
+	// Occlusion: one thread per pixel, the rows append to their own list which the compaction then reads in order
+	TArray<TArray<FCausticsEntryQueueItem>> RowEntryItems;
+	TArray<int32> RowLiveThreads;
+	RowEntryItems.SetNum(Output.DispatchSize.Y);
+	RowLiveThreads.SetNumZeroed(Output.DispatchSize.Y);
+	ParallelFor(Output.DispatchSize.Y, [this, &Output, &OutContexts, &Options, &LightCulling, &LightAliasTable, &RowEntryItems, &RowLiveThreads](int32 DispatchY)
+	{
+		FThreadContext& Context = OutContexts[DispatchY];
+
+		// Matches the early out at the top of the shader, before any ray is traced
+		if (Parameters.MaxRefractionRays <= 2)
+		{
+			return;
+		}
+
+		TArray<FCausticsRay> PrimaryRays;
+		TArray<FCausticsHit> PrimaryHits;
+		TracePrimaryRays(DispatchY, Output.DispatchSize.X, Options, PrimaryRays, PrimaryHits);
+
+		for (int32 DispatchX = 0; DispatchX < Output.DispatchSize.X; ++DispatchX)
+		{
+			const uint64 NumRaysBefore = Context.Stats.GetTotal();
+			Context.Stats.NumRays[ECausticsRayType::Primary]++;
+			RowLiveThreads[DispatchY] += PrimaryHits[DispatchX].IsHit() ? 1 : 0;
+			TraceOcclusionStage(FIntPoint(DispatchX, DispatchY), PrimaryRays[DispatchX], PrimaryHits[DispatchX], LightCulling, LightAliasTable, Context, RowEntryItems[DispatchY]);
+			Output.RayCounts[DispatchY * Output.DispatchSize.X + DispatchX] = uint32(Context.Stats.GetTotal() - NumRaysBefore);
+		}
+	}, Options.bForceSingleThread);
+
+	FCausticsWavefrontStageStats& OcclusionStats = Output.WavefrontStats[ECausticsWavefrontStage::Occlusion];
+	OcclusionStats.NumThreads = NumDispatchThreads;
+	for (int32 DispatchY = 0; DispatchY < Output.DispatchSize.Y; ++DispatchY)
+	{
+		OcclusionStats.NumLiveThreads += RowLiveThreads[DispatchY];
+		OcclusionStats.NumRays += OutContexts[DispatchY].Stats.GetTotal();
+	}
+
+	TArray<FCausticsEntryQueueItem> EntryQueue;
+	CompactCausticsQueue(RowEntryItems, QueueCapacity, EntryQueue, OcclusionStats);
+	RowEntryItems.Empty();
+
+	// The later stages read their queue in chunks, each with its own context and list of appended items
+	auto RunQueueStage = [&Options, &OutContexts, &Output, DispatchWidth](ECausticsWavefrontStage::Type Stage, int32 Capacity, int32 NumItems, TFunctionRef<void(int32 ChunkIndex, int32 ItemIndex, FThreadContext& Context)> StageFunction)
+	{
+		const int32 NumChunks = FMath::DivideAndRoundUp(NumItems, CausticsWavefrontChunkSize);
+		TArray<FThreadContext> ChunkContexts;
+		ChunkContexts.SetNum(NumChunks);
+		ParallelFor(NumChunks, [NumItems, &ChunkContexts, &StageFunction](int32 ChunkIndex)
+		{
+			const int32 EndIndex = FMath::Min((ChunkIndex + 1) * CausticsWavefrontChunkSize, NumItems);
+			for (int32 ItemIndex = ChunkIndex * CausticsWavefrontChunkSize; ItemIndex < EndIndex; ++ItemIndex)
+			{
+				StageFunction(ChunkIndex, ItemIndex, ChunkContexts[ChunkIndex]);
+			}
+		}, Options.bForceSingleThread);
+
+		FCausticsWavefrontStageStats& StageStats = Output.WavefrontStats[Stage];
+		StageStats.NumThreads = GetCausticsWavefrontStageThreads(Capacity, DispatchWidth);
+		StageStats.NumLiveThreads = NumItems;
+		for (FThreadContext& Context : ChunkContexts)
+		{
+			StageStats.NumRays += Context.Stats.GetTotal();
+			OutContexts.Add(MoveTemp(Context));
+		}
+	};
+
+	// Entry
+	TArray<TArray<FCausticsExitQueueItem>> ChunkExitItems;
+	ChunkExitItems.SetNum(FMath::DivideAndRoundUp(EntryQueue.Num(), CausticsWavefrontChunkSize));
+	RunQueueStage(ECausticsWavefrontStage::Entry, QueueCapacity, EntryQueue.Num(), [this, &EntryQueue, &ChunkExitItems](int32 ChunkIndex, int32 ItemIndex, FThreadContext& Context)
+	{
+		TraceEntryStage(EntryQueue[ItemIndex], Context, ChunkExitItems[ChunkIndex]);
+	});
+
+	TArray<FCausticsExitQueueItem> ExitQueue;
+	CompactCausticsQueue(ChunkExitItems, QueueCapacity, ExitQueue, Output.WavefrontStats[ECausticsWavefrontStage::Entry]);
+	ChunkExitItems.Empty();
+
+	// Exit
+	TArray<TArray<FCausticsReceiverQueueItem>> ChunkReceiverItems;
+	ChunkReceiverItems.SetNum(FMath::DivideAndRoundUp(ExitQueue.Num(), CausticsWavefrontChunkSize));
+	RunQueueStage(ECausticsWavefrontStage::Exit, QueueCapacity, ExitQueue.Num(), [this, &ExitQueue, &ChunkReceiverItems](int32 ChunkIndex, int32 ItemIndex, FThreadContext& Context)
+	{
+		TraceExitStage(ExitQueue[ItemIndex], Context, ChunkReceiverItems[ChunkIndex]);
+	});
+
+	TArray<FCausticsReceiverQueueItem> ReceiverQueue;
+	CompactCausticsQueue(ChunkReceiverItems, ReceiverQueueCapacity, ReceiverQueue, Output.WavefrontStats[ECausticsWavefrontStage::Exit]);
+	ChunkReceiverItems.Empty();
+
+	// Receiver, the splats are applied with those of every other context
+	RunQueueStage(ECausticsWavefrontStage::Receiver, ReceiverQueueCapacity, ReceiverQueue.Num(), [this, &ReceiverQueue](int32 ChunkIndex, int32 ItemIndex, FThreadContext& Context)
+	{
+		TraceReceiverStage(ReceiverQueue[ItemIndex], Context);
+	});
+}
+
+void FCausticsRenderer::TraceOcclusionStage(
+	FIntPoint DispatchThreadId,
+	const FCausticsRay& Ray,
+	const FCausticsHit& PrimaryHit,
+	const FCausticsLightCulling& LightCulling,
+	const TArray<FCausticsLightAliasEntry>& LightAliasTable,
+	FThreadContext& Context,
+	TArray<FCausticsEntryQueueItem>& OutItems) const
+{
+	const FIntPoint PixelCoord = View.GetPixelCoord(DispatchThreadId, Parameters.UpscaleFactor);
+	const uint32 LinearIndex = PixelCoord.Y * View.BufferSize.X + PixelCoord.X;
+
+	FCausticsRandomSequence RandSequence;
+	RandomSequence_Initialize(RandSequence, LinearIndex, View.StateFrameIndex);
+
+	const uint32 RayFlags = ECausticsRayFlags::CullBackFacingTriangles;
+	const FCausticsMaterialPayload Payload = GetMaterialPayload(PrimaryHit);
+	if (!Payload.IsHit())
+	{
+		return;
+	}
+
+	const FVector OcclusionPosition = Ray.Origin + Ray.Direction * Payload.HitT;
+	const int32 LightCullingCluster = LightCulling.GetCluster(View, DispatchThreadId, OcclusionPosition);
+	for (FCausticsLightLoop LightLoop(LightCulling, LightAliasTable, Parameters.LightSamplesPerPixel, LightCullingCluster, Scene.Lights.Num(), RandSequence); !LightLoop.IsDone(); LightLoop.Advance(RandSequence))
+	{
+		const FCausticsLight& Light = Scene.Lights[LightLoop.LightIndex];
+		if (LightLoop.LightWeight <= 0.0f || Light.Type > ECausticsLightType::Rect)
+		{
+			continue;
+		}
+
+		const FVector2D RandSample = RandomSequence_GenerateSample2D(RandSequence);
+
+		FCausticsRay OcclusionRay;
+		if (!GenerateOcclusionRayWithLightingData(Light, OcclusionPosition, Payload.WorldNormal, RandSample, OcclusionRay))
+		{
+			continue;
+		}
+
+		// Only opaque instances are under the mask, any of them in between shadows the light
+		FCausticsVisibilityPayload OcclusionPayload = TraceVisibilityRay(OcclusionRay, RayFlags | ECausticsRayFlags::AcceptFirstHitAndEndSearch, ECausticsInstanceMask::Opaque, ECausticsRayType::Occlusion, Context);
+		if (OcclusionPayload.IsHit())
+		{
+			continue;
+		}
+
+		OcclusionPayload = TraceVisibilityRay(OcclusionRay, RayFlags, ECausticsInstanceMask::Translucent, ECausticsRayType::TranslucentOcclusion, Context);
+		if (OcclusionPayload.IsMiss())
+		{
+			continue;
+		}
+
+		FCausticsEntryQueueItem& Item = OutItems.AddDefaulted_GetRef();
+		Item.DispatchThreadId = DispatchThreadId;
+		Item.PathSeed = GetCausticsPathSeed(LinearIndex, LightLoop.GetIteration());
+		Item.NumTransmissionSamples = Parameters.SamplesPerPixel;
+		Item.LightWeight = LightLoop.LightWeight;
+		Item.OcclusionOrigin = OcclusionRay.Origin;
+		Item.OcclusionTMax = OcclusionRay.TMax;
+		Item.OcclusionDirection = OcclusionRay.Direction;
+		Item.TranslucentHitT = OcclusionPayload.HitT;
+		Item.ReceiverRoughness = Payload.Roughness;
+	}
+}
+
+void FCausticsRenderer::TraceEntryStage(const FCausticsEntryQueueItem& Item, FThreadContext& Context, TArray<FCausticsExitQueueItem>& OutItems) const
+{
+	FCausticsRandomSequence RandSequence;
+	RandomSequence_Initialize(RandSequence, Item.PathSeed, GetCausticsWavefrontTimeSeed(View.StateFrameIndex, ECausticsWavefrontStage::Entry + 1));
+
+	const float LocalMaxRayDistance = GetProbeMaxRayDistance(Item.ReceiverRoughness);
+
+	const uint32 RayFlags = 0;
+	FCausticsRay ProbeRay;
+	ProbeRay.Origin = Item.OcclusionOrigin + Item.OcclusionDirection * Item.TranslucentHitT;
+	ProbeRay.Direction = Item.OcclusionDirection;
+	ProbeRay.TMax = LocalMaxRayDistance;
+	ProbeRay.TMin = 0.1f;
+
+	FCausticsMaterialPayload ProbePayload = TraceMaterialRay(ProbeRay, RayFlags, ECausticsInstanceMask::Translucent, ECausticsRayType::Probe, Context);
+	if (ProbePayload.IsFrontFace())
+	{
+		return;
+	}
+
+	FVector IncidentRadiance(0.0f, 0.0f, 0.0f);
+	{
+		FCausticsRay IncidentRay;
+		IncidentRay.Origin = ProbeRay.Origin + ProbeRay.Direction * (ProbePayload.HitT + 50.0f);
+		IncidentRay.Direction = -ProbeRay.Direction;
+		IncidentRay.TMax = LocalMaxRayDistance;
+		IncidentRay.TMin = 0.1f;
+
+		const FCausticsMaterialPayload IncidentPayload = TraceRayAndAccumulateResults(
+			IncidentRay,
+			ECausticsRayFlags::CullBackFacingTriangles,
+			ECausticsInstanceMask::All,
+			RandSequence,
+			IncidentRadiance,
+			Context);
+
+		IncidentRadiance *= (1.0f - IncidentPayload.Opacity);
+	}
+	IncidentRadiance *= Item.LightWeight;
+
+	float PathThroughput = 1.0f;
+	FCausticsRay AbsorptionRay;
+	AbsorptionRay.Origin = ProbeRay.Origin + ProbeRay.Direction * ProbePayload.HitT;
+	AbsorptionRay.TMax = Item.OcclusionTMax;
+	AbsorptionRay.TMin = 0.01f;
+	if (ProbePayload.Roughness > 0)
+	{
+		BiasNormal(RandSequence, ProbePayload.WorldNormal, ProbePayload.Roughness);
+	}
+	AbsorptionRay.Direction = RefractRay(
+		-ProbeRay.Direction,
+		ProbePayload.WorldNormal,
+		GetDielectricIor(ProbePayload.Specular),
+		true,
+		PathThroughput);
+
+	const FCausticsMaterialPayload AbsorptionPayload = TraceMaterialRay(AbsorptionRay, RayFlags, ECausticsInstanceMask::All, ECausticsRayType::Absorption, Context);
+
+	IncidentRadiance -= RayAbsorb(AbsorptionPayload.DiffuseColor, AbsorptionPayload.HitT, AbsorptionPayload.Ior) * 12.0f;
+	const bool bIsInside = AbsorptionPayload.IsFrontFace() && AbsorptionPayload.BlendingMode == ECausticsBlendMode::Opaque;
+	if (bIsInside)
+	{
+		return;
+	}
+
+	FCausticsExitQueueItem& ExitItem = OutItems.AddDefaulted_GetRef();
+	ExitItem.DispatchThreadId = Item.DispatchThreadId;
+	ExitItem.PathSeed = Item.PathSeed;
+	ExitItem.NumTransmissionSamples = Item.NumTransmissionSamples;
+	ExitItem.IncidentRadiance = IncidentRadiance * (1.0f - AbsorptionPayload.Opacity);
+	ExitItem.ExitOrigin = AbsorptionRay.Origin + AbsorptionRay.Direction * AbsorptionPayload.HitT;
+	ExitItem.ExitTMax = AbsorptionRay.TMax - AbsorptionPayload.HitT;
+	ExitItem.InsideDirection = AbsorptionRay.Direction;
+	ExitItem.ExitRoughness = AbsorptionPayload.Roughness;
+	ExitItem.ExitNormal = AbsorptionPayload.WorldNormal;
+	ExitItem.ExitSpecular = AbsorptionPayload.Specular;
+	ExitItem.ExitOpacity = AbsorptionPayload.Opacity;
+}
+
+void FCausticsRenderer::TraceExitStage(const FCausticsExitQueueItem& Item, FThreadContext& Context, TArray<FCausticsReceiverQueueItem>& OutItems) const
+{
+	FCausticsRandomSequence RandSequence;
+	RandomSequence_Initialize(RandSequence, Item.PathSeed, GetCausticsWavefrontTimeSeed(View.StateFrameIndex, ECausticsWavefrontStage::Exit + 1));
+
+	float PathThroughput = 1.0f;
+	const uint32 RayFlags = ECausticsRayFlags::CullBackFacingTriangles;
+	const float Ior = GetDielectricIor(Item.ExitSpecular);
+
+	FCausticsRay TransmissionRay;
+	TransmissionRay.Origin = Item.ExitOrigin;
+	TransmissionRay.TMax = Item.ExitTMax;
+	TransmissionRay.TMin = 0.01f;
+
+	auto AppendReceiverHit = [this, &OutItems](const FVector& HitPosition, float TransmissionHitT, const FLinearColor& Color)
+	{
+		FCausticsReceiverQueueItem& ReceiverItem = OutItems.AddDefaulted_GetRef();
+		ReceiverItem.ThreadId = View.GenerateThreadId(HitPosition, Parameters.UpscaleFactor);
+		ReceiverItem.HitPosition = HitPosition;
+		ReceiverItem.TransmissionHitT = TransmissionHitT;
+		ReceiverItem.Color = Color;
+	};
+
+	// Like the megakernel, every sample bends the normal the previous one left
+	FVector ExitNormal = Item.ExitNormal;
+
+	// Distribution method
+	if (Parameters.SamplesPerPixel <= 1 || Item.ExitRoughness == 0)
+	{
+		if (Item.ExitRoughness > 0)
+		{
+			BiasNormal(RandSequence, ExitNormal, Item.ExitRoughness);
+		}
+		TransmissionRay.Direction = RefractRay(Item.InsideDirection, ExitNormal, Ior, false, PathThroughput);
+
+		const FCausticsMaterialPayload TransmissionPayload = TraceMaterialRay(TransmissionRay, RayFlags, ECausticsInstanceMask::All, ECausticsRayType::Transmission, Context);
+		if (!TransmissionPayload.IsMiss() && TransmissionPayload.IsFrontFace())
+		{
+			FVector IncidentRadiance = Item.IncidentRadiance;
+			if (TransmissionPayload.BlendingMode == ECausticsBlendMode::Translucent)
+			{
+				IncidentRadiance *= TransmissionPayload.Opacity;
+			}
+			const FVector HitPosition = TransmissionRay.Origin + TransmissionRay.Direction * TransmissionPayload.HitT;
+			AppendReceiverHit(HitPosition, TransmissionPayload.HitT, ClampToHalfFloatRange(FLinearColor(IncidentRadiance.X, IncidentRadiance.Y, IncidentRadiance.Z, Item.ExitOpacity)));
+		}
+	}
+	else
+	{
+		for (int32 SampleIndex = 0; SampleIndex < Item.NumTransmissionSamples; ++SampleIndex)
+		{
+			float Weight = 0.0f;
+			if (Item.ExitRoughness > 0)
+			{
+				Weight = BiasNormal(RandSequence, ExitNormal, Item.ExitRoughness);
+			}
+			TransmissionRay.Direction = RefractRay(Item.InsideDirection, ExitNormal, Ior, false, PathThroughput);
+			Weight = FMath::Min(FMath::Clamp(Weight, 0.0f, 1.0f), ExitNormal | TransmissionRay.Direction);
+
+			const FCausticsMaterialPayload TransmissionPayload = TraceMaterialRay(TransmissionRay, RayFlags, ECausticsInstanceMask::All, ECausticsRayType::Transmission, Context);
+			if (!TransmissionPayload.IsMiss() && TransmissionPayload.IsFrontFace())
+			{
+				FVector SampleRadiance = Item.IncidentRadiance;
+				if (TransmissionPayload.BlendingMode == ECausticsBlendMode::Translucent)
+				{
+					SampleRadiance *= TransmissionPayload.Opacity;
+				}
+				const FVector HitPosition = TransmissionRay.Origin + TransmissionRay.Direction * TransmissionPayload.HitT;
+				AppendReceiverHit(HitPosition, TransmissionPayload.HitT, ClampToHalfFloatRange(FLinearColor(SampleRadiance.X, SampleRadiance.Y, SampleRadiance.Z, Item.ExitOpacity) * Weight) * (1.0f / Item.NumTransmissionSamples));
+			}
+		}
+	}
+}
+
+void FCausticsRenderer::TraceReceiverStage(const FCausticsReceiverQueueItem& Item, FThreadContext& Context) const
+{
+	const FVector2D InvBufferSize = View.GetInvBufferSize();
+	const FIntPoint TransPixelCoord = View.GetPixelCoord(Item.ThreadId, Parameters.UpscaleFactor);
+	const FVector2D TransUV((TransPixelCoord.X + 0.5f) * InvBufferSize.X, (TransPixelCoord.Y + 0.5f) * InvBufferSize.Y);
+	float ImaginaryDepth;
+	if (CheckDepthAvalible(TransUV, Item.HitPosition, ImaginaryDepth, Context))
+	{
+		FSplat& Splat = Context.Splats.AddDefaulted_GetRef();
+		Splat.ThreadId = Item.ThreadId;
+		Splat.Color = Item.Color;
+		Splat.TransmissionHitT = Item.TransmissionHitT;
+		Splat.ImaginaryDepth = ImaginaryDepth;
+	}
+}
+
+void FCausticsRenderer::LightSpaceRayGen(FIntPoint DispatchThreadId, FThreadContext& Context) const
+{
+	const int32 Resolution = Parameters.LightSpaceResolution;
+	const int32 TargetIndex = DispatchThreadId.Y / Resolution;
+	const FIntPoint CellCoord(DispatchThreadId.X, DispatchThreadId.Y % Resolution);
+	const uint32 LinearIndex = DispatchThreadId.Y * Resolution + DispatchThreadId.X;
+
+	if (Parameters.MaxRefractionRays <= 2 || !EmitterTargets.IsValidIndex(TargetIndex))
+	{
+		return;
+	}
+
+	FCausticsRandomSequence RandSequence;
+	RandomSequence_Initialize(RandSequence, LinearIndex, View.StateFrameIndex);
+
+	const FVector4& Target = EmitterTargets[TargetIndex];
+	const FVector TargetCenter(Target.X, Target.Y, Target.Z);
+	const float DiskArea = PI * FMath::Square(Target.W);
+	const float InvNumCells = 1.0f / float(Resolution * Resolution);
+
+	uint32 RayFlags = 0;
+	for (const FCausticsLight& Light : Scene.Lights)
+	{
+		if (Light.Type > ECausticsLightType::Rect)
+		{
+			continue;
+		}
+
+		const FVector2D CellUV = (FVector2D(CellCoord.X, CellCoord.Y) + RandomSequence_GenerateSample2D(RandSequence)) / float(Resolution);
+
+		FCausticsRay EmissionRay;
+		float DiskDistance;
+		if (!GenerateEmissionRayWithLightingData(Light, TargetCenter, Target.W, CellUV, EmissionRay, DiskDistance))
+		{
+			continue;
+		}
+
+		// The closest hit must be the front face of a dielectric, anything opaque in between shadows the caustic
+		RayFlags = 0;
+		const FCausticsMaterialPayload EntryPayload = TraceMaterialRay(EmissionRay, RayFlags, ECausticsInstanceMask::All, ECausticsRayType::Emission, Context);
+		if (EntryPayload.IsMiss() || !EntryPayload.IsFrontFace() || EntryPayload.BlendingMode == ECausticsBlendMode::Opaque)
+		{
+			continue;
+		}
+
+		const FVector EntryPosition = EmissionRay.Origin + EmissionRay.Direction * EntryPayload.HitT;
+		FVector IncidentRadiance = GetLightIrradiance(Light, -EmissionRay.Direction, EntryPayload.HitT);
+		IncidentRadiance *= (1.0f - EntryPayload.Opacity);
+
+		// Footprint of the ray where it enters the dielectric, the disk area is shared by all cells and scaled to the hit distance
+		const float RayFootprint = DiskArea * InvNumCells * FMath::Square(EntryPayload.HitT / DiskDistance);
+
+		TraceLightHalfPath(RandSequence, EntryPosition, EmissionRay.Direction, 1e27f, EntryPayload, IncidentRadiance, RayFootprint, RayFlags, Context);
+	}
+}
+
+float FCausticsRenderer::GetSplatScale(float RayFootprint, const FVector& HitPosition) const
+{
+	if (RayFootprint <= 0.0f)
+	{
+		return 1.0f;
+	}
+	const float PixelFootprint = (HitPosition - View.WorldCameraOrigin).Size() * View.EyeToPixelSpreadAngle * Parameters.UpscaleFactor;
+	return RayFootprint / FMath::Max(FMath::Square(PixelFootprint), 1e-6f);
+}
+
+void FCausticsRenderer::TraceLightHalfPath(
+	FCausticsRandomSequence& RandSequence,
+	const FVector& EntryPosition,
+	const FVector& TravelDirection,
+	float AbsorptionMaxRayDistance,
+	FCausticsMaterialPayload EntryPayload,
+	FVector IncidentRadiance,
+	float RayFootprint,
+	uint32& RayFlags,
+	FThreadContext& Context) const
+{
+	const int32 UpscaleFactor = Parameters.UpscaleFactor;
+	const FVector2D InvBufferSize = View.GetInvBufferSize();
+	float PathThroughput = 1.0f;
+
+	FCausticsRay AbsorptionRay;
+	AbsorptionRay.Origin = EntryPosition;
+	AbsorptionRay.TMax = AbsorptionMaxRayDistance;
+	AbsorptionRay.TMin = 0.01f;
+	if (EntryPayload.Roughness > 0)
+	{
+		BiasNormal(RandSequence, EntryPayload.WorldNormal, EntryPayload.Roughness);
+	}
+	AbsorptionRay.Direction = RefractRay(
+		TravelDirection,
+		EntryPayload.WorldNormal,
+		GetDielectricIor(EntryPayload.Specular),
+		true,
+		PathThroughput);
+
+	FCausticsMaterialPayload AbsorptionPayload = TraceMaterialRay(AbsorptionRay, RayFlags, ECausticsInstanceMask::All, ECausticsRayType::Absorption, Context);
+
+	IncidentRadiance -= RayAbsorb(AbsorptionPayload.DiffuseColor, AbsorptionPayload.HitT, AbsorptionPayload.Ior) * 12.0f;
+	const bool bIsInside = AbsorptionPayload.IsFrontFace() && AbsorptionPayload.BlendingMode == ECausticsBlendMode::Opaque;
+	if (bIsInside)
+	{
+		return;
+	}
+
+	FCausticsRay TransmissionRay;
+	TransmissionRay.Origin = AbsorptionRay.Origin + AbsorptionRay.Direction * AbsorptionPayload.HitT;
+	TransmissionRay.TMax = AbsorptionRay.TMax - AbsorptionPayload.HitT;
+	TransmissionRay.TMin = 0.01f;
+	IncidentRadiance *= (1.0f - AbsorptionPayload.Opacity);
+
+	// Distribution method
+	if (Parameters.SamplesPerPixel <= 1 || AbsorptionPayload.Roughness == 0)
+	{
+		if (AbsorptionPayload.Roughness > 0)
+		{
+			BiasNormal(RandSequence, AbsorptionPayload.WorldNormal, AbsorptionPayload.Roughness);
+		}
+
+		TransmissionRay.Direction = RefractRay(
+			AbsorptionRay.Direction,
+			AbsorptionPayload.WorldNormal,
+			GetDielectricIor(AbsorptionPayload.Specular),
+			false,
+			PathThroughput);
+		RayFlags |= ECausticsRayFlags::CullBackFacingTriangles;
+		const FCausticsMaterialPayload TransmissionPayload = TraceMaterialRay(TransmissionRay, RayFlags, ECausticsInstanceMask::All, ECausticsRayType::Transmission, Context);
+
+		if (!TransmissionPayload.IsMiss() && TransmissionPayload.IsFrontFace())
+		{
+			const FVector HitPosition = TransmissionRay.Origin + TransmissionRay.Direction * TransmissionPayload.HitT;
+			const FIntPoint ThreadId = View.GenerateThreadId(HitPosition, UpscaleFactor);
+			const FIntPoint TransPixelCoord = View.GetPixelCoord(ThreadId, UpscaleFactor);
+			const FVector2D TransUV((TransPixelCoord.X + 0.5f) * InvBufferSize.X, (TransPixelCoord.Y + 0.5f) * InvBufferSize.Y);
+			float ImaginaryDepth;
+			if (CheckDepthAvalible(TransUV, HitPosition, ImaginaryDepth, Context))
+			{
+				if (TransmissionPayload.BlendingMode == ECausticsBlendMode::Translucent)
+				{
+					IncidentRadiance *= TransmissionPayload.Opacity;
+				}
+
+				FSplat& Splat = Context.Splats.AddDefaulted_GetRef();
+				Splat.ThreadId = ThreadId;
+				Splat.Color = ClampToHalfFloatRange(FLinearColor(IncidentRadiance.X, IncidentRadiance.Y, IncidentRadiance.Z, AbsorptionPayload.Opacity) * GetSplatScale(RayFootprint, HitPosition));
+				Splat.TransmissionHitT = TransmissionPayload.HitT;
+				Splat.ImaginaryDepth = ImaginaryDepth;
+			}
+		}
+	}
+	else
+	{
+		for (int32 SampleIndex = 0; SampleIndex < Parameters.SamplesPerPixel; ++SampleIndex)
+		{
+			FVector SampleRadiance = IncidentRadiance;
+			float Weight = 0.0f;
+			if (AbsorptionPayload.Roughness > 0)
+			{
+				Weight = BiasNormal(RandSequence, AbsorptionPayload.WorldNormal, AbsorptionPayload.Roughness);
+			}
+			TransmissionRay.Direction = RefractRay(
+				AbsorptionRay.Direction,
+				AbsorptionPayload.WorldNormal,
+				GetDielectricIor(AbsorptionPayload.Specular),
+				false,
+				PathThroughput);
+
+			Weight = FMath::Min(FMath::Clamp(Weight, 0.0f, 1.0f), AbsorptionPayload.WorldNormal | TransmissionRay.Direction);
+			RayFlags |= ECausticsRayFlags::CullBackFacingTriangles;
+			const FCausticsMaterialPayload TransmissionPayload = TraceMaterialRay(TransmissionRay, RayFlags, ECausticsInstanceMask::All, ECausticsRayType::Transmission, Context);
+
+			if (!TransmissionPayload.IsMiss() && TransmissionPayload.IsFrontFace())
+			{
+				const FVector HitPosition = TransmissionRay.Origin + TransmissionRay.Direction * TransmissionPayload.HitT;
+				const FIntPoint ThreadId = View.GenerateThreadId(HitPosition, UpscaleFactor);
+				const FIntPoint TransPixelCoord = View.GetPixelCoord(ThreadId, UpscaleFactor);
+				const FVector2D TransUV((TransPixelCoord.X + 0.5f) * InvBufferSize.X, (TransPixelCoord.Y + 0.5f) * InvBufferSize.Y);
+				float ImaginaryDepth;
+				if (CheckDepthAvalible(TransUV, HitPosition, ImaginaryDepth, Context))
+				{
+					if (TransmissionPayload.BlendingMode == ECausticsBlendMode::Translucent)
+					{
+						SampleRadiance *= TransmissionPayload.Opacity;
+					}
+
+					FSplat& Splat = Context.Splats.AddDefaulted_GetRef();
+					Splat.ThreadId = ThreadId;
+					Splat.Color = ClampToHalfFloatRange(FLinearColor(SampleRadiance.X, SampleRadiance.Y, SampleRadiance.Z, AbsorptionPayload.Opacity) * (Weight * GetSplatScale(RayFootprint, HitPosition))) * (1.0f / Parameters.SamplesPerPixel);
+					Splat.TransmissionHitT = TransmissionPayload.HitT;
+					Splat.ImaginaryDepth = ImaginaryDepth;
+				}
+			}
+		}
+	}
+}
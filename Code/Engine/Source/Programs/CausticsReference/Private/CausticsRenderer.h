@@ -0,0 +1,292 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CausticsAccumulation.h"
+#include "CausticsBVH.h"
+#include "CausticsRandomSequence.h"
+#include "CausticsWavefront.h"
+
+class FCausticsLightCulling;
+class FCausticsScene;
+struct FCausticsLightAliasEntry;
+struct FCausticsView;
+
+/** Every TraceRay issued by the caustics ray generation shader, counted separately. */
+namespace ECausticsRayType
+{
+	enum Type
+	{
+		Primary,
+		Occlusion,
+		TranslucentOcclusion,
+		Probe,
+		Incident,
+		IncidentShadow,
+		Absorption,
+		Transmission,
+		DepthCheck,
+		Emission,
+		Num,
+	};
+}
+
+const TCHAR* GetCausticsRayTypeName(ECausticsRayType::Type RayType);
+
+struct FCausticsRayStats
+{
+	uint64 NumRays[ECausticsRayType::Num] = {};
+
+	uint64 GetTotal() const;
+	void Accumulate(const FCausticsRayStats& Other);
+};
+
+/** Shader parameters of FRayTracingCausticsRGS that affect the CPU port, with the defaults RenderRayTracingCaustics ends up with. */
+struct FCausticsParameters
+{
+	int32 SamplesPerPixel = 1;
+	int32 MaxRefractionRays = 3;
+	int32 ReflectedShadowsType = 1;
+	int32 ShouldDoDirectLighting = 1;
+	int32 ShouldDoEmissiveAndIndirectLighting = 1;
+	int32 UpscaleFactor = 1;
+	uint32 PrimaryRayFlags = 0;
+	float TransmissionMinRayDistance = -1.0f;
+	float TransmissionMaxRayDistance = -1.0f;
+	float MaxNormalBias = 0.1f;
+
+	/** r.RayTracing.Caustics.Mode 1: light half paths start at the lights and aim at the translucent instances. */
+	bool bLightSpaceEmission = false;
+
+	/** r.RayTracing.Caustics.LightSpace.Resolution, rays per side of the grid emitted towards each target. */
+	int32 LightSpaceResolution = 256;
+
+	/** r.RayTracing.Caustics.LightCulling: the screen light loop only visits the lights that reach the cluster of the hit through a translucent instance. */
+	bool bLightCulling = true;
+
+	/** r.RayTracing.Caustics.LightSamplesPerPixel: lights drawn per pixel from the alias table, 0 visits every light. */
+	int32 LightSamplesPerPixel = 0;
+
+	/** r.RayTracing.Caustics.Wavefront: the screen space chain runs as queued stages instead of one megakernel. */
+	bool bWavefront = false;
+
+	/** r.RayTracing.Caustics.Wavefront.QueueItemsPerPixel, capacity of the queues between the stages. */
+	float WavefrontQueueItemsPerPixel = 1.0f;
+
+	/** r.RayTracing.Caustics.AccumulationScale, fixed point units per unit of radiance in the color accumulation buffer. */
+	float ColorAccumulationScale = DefaultCausticsAccumulationScale;
+};
+
+/** CPU counterpart of the FMaterialClosestHitPayload fields read by the caustics shader. */
+struct FCausticsMaterialPayload
+{
+	float HitT = -1.0f;
+	FVector WorldNormal = FVector::ZeroVector;
+	FVector Radiance = FVector::ZeroVector;
+	FVector BaseColor = FVector::ZeroVector;
+	FVector DiffuseColor = FVector::ZeroVector;
+	float Opacity = 0.0f;
+	float Roughness = 0.0f;
+	float Specular = 0.0f;
+	float Ior = 0.0f;
+	uint32 BlendingMode = 0;
+	bool bFrontFace = false;
+
+	bool IsHit() const
+	{
+		return HitT >= 0.0f;
+	}
+
+	bool IsMiss() const
+	{
+		return HitT < 0.0f;
+	}
+
+	bool IsFrontFace() const
+	{
+		return bFrontFace;
+	}
+};
+
+/** CPU counterpart of FMinimalPayload, returned by the visibility rays that skip the material evaluation. */
+struct FCausticsVisibilityPayload
+{
+	float HitT = -1.0f;
+
+	bool IsHit() const
+	{
+		return HitT >= 0.0f;
+	}
+
+	bool IsMiss() const
+	{
+		return HitT < 0.0f;
+	}
+};
+
+/** Execution options of the CPU port that do not exist on the GPU. */
+struct FCausticsRenderOptions
+{
+	bool bForceSingleThread = false;
+
+	/** Trace the primary rays of each dispatch row as packets instead of one at a time. */
+	bool bPrimaryRayPackets = true;
+};
+
+/** The UAVs written by RayTracingCausticsRGS at screen dispatch resolution, plus the ray counts. */
+struct FCausticsOutput
+{
+	FIntPoint Size = FIntPoint::ZeroValue;
+
+	/** Size of the dispatch that was traced, differs from Size with light space emission. */
+	FIntPoint DispatchSize = FIntPoint::ZeroValue;
+
+	/** Resolved from ColorAccumulation once every splat has been applied. */
+	TArray<FLinearColor> Color;
+
+	/** Fixed point color, four channels per pixel, as accumulated with atomics by the shader. */
+	TArray<uint32> ColorAccumulation;
+	TArray<float> RayHitDistance;
+	TArray<float> RayImaginaryDepth;
+
+	/** Rays traced by each dispatch thread, DispatchSize.X threads per row. Only the occlusion stage in wavefront mode. */
+	TArray<uint32> RayCounts;
+	FCausticsRayStats Stats;
+
+	/** Filled in wavefront mode. */
+	bool bWavefront = false;
+	FCausticsWavefrontStageStats WavefrontStats[ECausticsWavefrontStage::Num];
+};
+
+/**
+ * Multi-threaded CPU port of RayTracingCausticsRGS.
+ *
+ * The light half path mirrors the shader statement for statement, including the state it carries between lights
+ * (RayFlags, RayCone is omitted since no LOD is used). Dispatch rows run in parallel and record their scattered
+ * writes, which are then applied in dispatch order so that the result does not depend on thread scheduling.
+ * Lighting on incident ray hits is a Lambert approximation of TraceRayAndAccumulateResults without sky light.
+ */
+class FCausticsRenderer
+{
+public:
+	FCausticsRenderer(const FCausticsScene& InScene, const FCausticsBVH& InBVH, const FCausticsView& InView, const FCausticsParameters& InParameters);
+
+	/** Screen dispatch size, the size of the outputs. */
+	FIntPoint GetDispatchSize() const;
+
+	/** One LightSpaceResolution square grid per emitter target, stacked along y. */
+	FIntPoint GetLightSpaceDispatchSize() const;
+
+	void Render(FCausticsOutput& Output, const FCausticsRenderOptions& Options) const;
+
+	/**
+	 * Normal in xyz and scene depth in w of the opaque receiver behind every output texel, 0 depth where nothing is hit.
+	 * The caustics filter reads them from the G-buffer, which only holds opaque surfaces.
+	 */
+	void RenderDenoiserGuide(TArray<FVector4>& OutGuide, const FCausticsRenderOptions& Options) const;
+
+private:
+	/** A scattered write to the color accumulation and the auxiliary outputs, as issued by the light half path. */
+	struct FSplat
+	{
+		FIntPoint ThreadId;
+		FLinearColor Color;
+		float TransmissionHitT;
+		float ImaginaryDepth;
+	};
+
+	struct FThreadContext
+	{
+		FCausticsRayStats Stats;
+		TArray<FSplat> Splats;
+	};
+
+	/** Primary ray of a dispatch thread, shared by the packet path and RayGen(). */
+	FCausticsRay CreatePrimaryRay(FIntPoint DispatchThreadId) const;
+
+	/** Primary rays of a dispatch row, as packets if the options ask for it. */
+	void TracePrimaryRays(int32 DispatchY, int32 DispatchWidth, const FCausticsRenderOptions& Options, TArray<FCausticsRay>& OutRays, TArray<FCausticsHit>& OutHits) const;
+
+	/** RayTracingCausticsRGS from the primary hit on. The primary ray is traced by the caller so that it can be batched. */
+	void RayGen(
+		FIntPoint DispatchThreadId,
+		const FCausticsRay& Ray,
+		const FCausticsHit& PrimaryHit,
+		const FCausticsLightCulling& LightCulling,
+		const TArray<FCausticsLightAliasEntry>& LightAliasTable,
+		FThreadContext& Context) const;
+
+	FCausticsMaterialPayload GetMaterialPayload(const FCausticsHit& Hit) const;
+
+	FCausticsMaterialPayload TraceMaterialRay(const FCausticsRay& Ray, uint32 RayFlags, uint32 InstanceInclusionMask, ECausticsRayType::Type RayType, FThreadContext& Context) const;
+
+	/** TraceVisibilityRay() of the shaders: the occlusion and depth check rays only need the distance of their hit. */
+	FCausticsVisibilityPayload TraceVisibilityRay(const FCausticsRay& Ray, uint32 RayFlags, uint32 InstanceInclusionMask, ECausticsRayType::Type RayType, FThreadContext& Context) const;
+
+	FCausticsMaterialPayload TraceRayAndAccumulateResults(
+		const FCausticsRay& Ray,
+		uint32 RayFlags,
+		uint32 InstanceInclusionMask,
+		FCausticsRandomSequence& RandSequence,
+		FVector& OutRadiance,
+		FThreadContext& Context) const;
+
+	/** Every stage of the wavefront caustics in turn, the splats land in OutContexts. */
+	void RenderWavefront(
+		FCausticsOutput& Output,
+		const FCausticsRenderOptions& Options,
+		const FCausticsLightCulling& LightCulling,
+		const TArray<FCausticsLightAliasEntry>& LightAliasTable,
+		TArray<FThreadContext>& OutContexts) const;
+
+	/** TraceCausticsOcclusionStage(), from the primary hit on. */
+	void TraceOcclusionStage(
+		FIntPoint DispatchThreadId,
+		const FCausticsRay& Ray,
+		const FCausticsHit& PrimaryHit,
+		const FCausticsLightCulling& LightCulling,
+		const TArray<FCausticsLightAliasEntry>& LightAliasTable,
+		FThreadContext& Context,
+		TArray<FCausticsEntryQueueItem>& OutItems) const;
+
+	/** TraceCausticsEntryStage() */
+	void TraceEntryStage(const FCausticsEntryQueueItem& Item, FThreadContext& Context, TArray<FCausticsExitQueueItem>& OutItems) const;
+
+	/** TraceCausticsExitStage() */
+	void TraceExitStage(const FCausticsExitQueueItem& Item, FThreadContext& Context, TArray<FCausticsReceiverQueueItem>& OutItems) const;
+
+	/** TraceCausticsReceiverStage() */
+	void TraceReceiverStage(const FCausticsReceiverQueueItem& Item, FThreadContext& Context) const;
+
+	/** RayTracingCausticsRGS with DIM_LIGHT_SPACE_EMISSION. */
+	void LightSpaceRayGen(FIntPoint DispatchThreadId, FThreadContext& Context) const;
+
+	/** Refracts the light half path through the dielectric entered at EntryPosition and splats it where it lands. */
+	void TraceLightHalfPath(
+		FCausticsRandomSequence& RandSequence,
+		const FVector& EntryPosition,
+		const FVector& TravelDirection,
+		float AbsorptionMaxRayDistance,
+		FCausticsMaterialPayload EntryPayload,
+		FVector IncidentRadiance,
+		float RayFootprint,
+		uint32& RayFlags,
+		FThreadContext& Context) const;
+
+	/** GetProbeMaxRayDistance(): farthest the probe and incident rays of a screen pixel go, from the roughness of its receiver. */
+	float GetProbeMaxRayDistance(float Roughness) const;
+
+	/** Ratio of the area a light path stands for to the area of the dispatch pixel it lands in, 1 for paths started from a pixel. */
+	float GetSplatScale(float RayFootprint, const FVector& HitPosition) const;
+
+	bool CheckDepthAvalible(const FVector2D& UV, const FVector& WorldPosition, float& OutImaginaryDepth, FThreadContext& Context) const;
+
+	void ApplySplat(const FSplat& Splat, FCausticsOutput& Output) const;
+
+	const FCausticsScene& Scene;
+	const FCausticsBVH& BVH;
+	const FCausticsView& View;
+	FCausticsParameters Parameters;
+
+	/** Bounding spheres of the translucent instances, xyz is the center and w the radius. Emission and light culling targets. */
+	TArray<FVector4> EmitterTargets;
+};
@@ -0,0 +1,322 @@
+#include "CausticsScene.h"
+#include "CausticsReference.h"
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	bool ParseFloat(const TArray<FString>& Tokens, int32 TokenIndex, float& OutValue)
+	{
+		if (!Tokens.IsValidIndex(TokenIndex))
+		{
+			return false;
+		}
+		OutValue = FCString::Atof(*Tokens[TokenIndex]);
+		return true;
+	}
+
+	bool ParseVector(const TArray<FString>& Tokens, int32 TokenIndex, FVector& OutValue)
+	{
+		return ParseFloat(Tokens, TokenIndex + 0, OutValue.X)
+			&& ParseFloat(Tokens, TokenIndex + 1, OutValue.Y)
+			&& ParseFloat(Tokens, TokenIndex + 2, OutValue.Z);
+	}
+
+	/** Optional "<key> <value...>" pairs trailing the positional arguments of a statement. */
+	struct FOptionalArguments
+	{
+		FOptionalArguments(const TArray<FString>& InTokens, int32 InFirstToken)
+			: Tokens(InTokens)
+			, FirstToken(InFirstToken)
+		{
+		}
+
+		int32 FindKey(const TCHAR* Key) const
+		{
+			for (int32 TokenIndex = FirstToken; TokenIndex < Tokens.Num(); ++TokenIndex)
+			{
+				if (Tokens[TokenIndex] == Key)
+				{
+					return TokenIndex + 1;
+				}
+			}
+			return INDEX_NONE;
+		}
+
+		void GetFloat(const TCHAR* Key, float& InOutValue) const
+		{
+			const int32 ValueIndex = FindKey(Key);
+			if (ValueIndex != INDEX_NONE)
+			{
+				ParseFloat(Tokens, ValueIndex, InOutValue);
+			}
+		}
+
+		void GetVector(const TCHAR* Key, FVector& InOutValue) const
+		{
+			const int32 ValueIndex = FindKey(Key);
+			if (ValueIndex != INDEX_NONE)
+			{
+				ParseVector(Tokens, ValueIndex, InOutValue);
+			}
+		}
+
+		const TArray<FString>& Tokens;
+		int32 FirstToken;
+	};
+
+	bool ParseLight(const TArray<FString>& Tokens, FCausticsLight& OutLight)
+	{
+		const FString& TypeName = Tokens.IsValidIndex(1) ? Tokens[1] : FString();
+		float AttenuationRadius = 1000.0f;
+
+		if (TypeName == TEXT("directional"))
+		{
+			FVector Forward;
+			if (!ParseVector(Tokens, 2, Forward) || !ParseVector(Tokens, 5, OutLight.LightColor))
+			{
+				return false;
+			}
+			OutLight.Type = ECausticsLightType::Directional;
+			OutLight.Direction = -Forward.GetSafeNormal();
+			FOptionalArguments(Tokens, 8).GetFloat(TEXT("radius"), OutLight.SourceRadius);
+			return true;
+		}
+		else if (TypeName == TEXT("point"))
+		{
+			if (!ParseVector(Tokens, 2, OutLight.LightPosition) || !ParseVector(Tokens, 5, OutLight.LightColor))
+			{
+				return false;
+			}
+			const FOptionalArguments Optional(Tokens, 8);
+			Optional.GetFloat(TEXT("radius"), OutLight.SourceRadius);
+			Optional.GetFloat(TEXT("attenuation"), AttenuationRadius);
+			OutLight.Type = ECausticsLightType::Point;
+			OutLight.InvRadius = 1.0f / FMath::Max(AttenuationRadius, KINDA_SMALL_NUMBER);
+			return true;
+		}
+		else if (TypeName == TEXT("spot"))
+		{
+			FVector Forward;
+			float OuterConeDegrees;
+			if (!ParseVector(Tokens, 2, OutLight.LightPosition) || !ParseVector(Tokens, 5, Forward)
+				|| !ParseVector(Tokens, 8, OutLight.LightColor) || !ParseFloat(Tokens, 11, OuterConeDegrees))
+			{
+				return false;
+			}
+			const FOptionalArguments Optional(Tokens, 12);
+			Optional.GetFloat(TEXT("radius"), OutLight.SourceRadius);
+			Optional.GetFloat(TEXT("attenuation"), AttenuationRadius);
+
+			const float CosOuterCone = FMath::Cos(FMath::Clamp(OuterConeDegrees, 1.0f, 89.0f) * PI / 180.0f);
+			const float CosInnerCone = FMath::Cos(FMath::Clamp(OuterConeDegrees * 0.8f, 0.0f, 89.0f) * PI / 180.0f);
+			OutLight.Type = ECausticsLightType::Spot;
+			OutLight.Direction = -Forward.GetSafeNormal();
+			OutLight.Tangent = (Forward ^ FVector(0.0f, 0.0f, 1.0f)).GetSafeNormal();
+			if (OutLight.Tangent.IsZero())
+			{
+				OutLight.Tangent = FVector(1.0f, 0.0f, 0.0f);
+			}
+			OutLight.SpotAngles = FVector2D(CosOuterCone, 1.0f / FMath::Max(CosInnerCone - CosOuterCone, 0.01f));
+			OutLight.InvRadius = 1.0f / FMath::Max(AttenuationRadius, KINDA_SMALL_NUMBER);
+			return true;
+		}
+		else if (TypeName == TEXT("rect"))
+		{
+			FVector Forward;
+			FVector Tangent;
+			float Width;
+			float Height;
+			if (!ParseVector(Tokens, 2, OutLight.LightPosition) || !ParseVector(Tokens, 5, Forward) || !ParseVector(Tokens, 8, Tangent)
+				|| !ParseVector(Tokens, 11, OutLight.LightColor) || !ParseFloat(Tokens, 14, Width) || !ParseFloat(Tokens, 15, Height))
+			{
+				return false;
+			}
+			FOptionalArguments(Tokens, 16).GetFloat(TEXT("attenuation"), AttenuationRadius);
+
+			OutLight.Type = ECausticsLightType::Rect;
+			OutLight.Direction = -Forward.GetSafeNormal();
+			OutLight.Tangent = Tangent.GetSafeNormal();
+			OutLight.SourceRadius = 0.5f * Width;
+			OutLight.SourceLength = 0.5f * Height;
+			OutLight.InvRadius = 1.0f / FMath::Max(AttenuationRadius, KINDA_SMALL_NUMBER);
+			return true;
+		}
+		return false;
+	}
+}
+
+int32 FCausticsScene::FindMaterial(const FString& Name) const
+{
+	for (int32 MaterialIndex = 0; MaterialIndex < Materials.Num(); ++MaterialIndex)
+	{
+		if (Materials[MaterialIndex].Name == Name)
+		{
+			return MaterialIndex;
+		}
+	}
+	return INDEX_NONE;
+}
+
+void FCausticsScene::BeginInstance(const FString& Name)
+{
+	if (Instances.Num() > 0 && Instances.Last().NumTriangles == 0)
+	{
+		Instances.Last().Name = Name;
+		return;
+	}
+
+	FCausticsInstance& Instance = Instances.AddDefaulted_GetRef();
+	Instance.Name = Name;
+	Instance.FirstTriangle = NumTriangles();
+}
+
+bool FCausticsScene::LoadFromFile(const TCHAR* Filename)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, Filename))
+	{
+		UE_LOG(LogCausticsReference, Error, TEXT("Failed to read scene file %s"), Filename);
+		return false;
+	}
+
+	int32 CurrentMaterial = INDEX_NONE;
+	TArray<FString> Tokens;
+
+	for (int32 LineIndex = 0; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		Lines[LineIndex].ParseIntoArrayWS(Tokens);
+		if (Tokens.Num() == 0 || Tokens[0].StartsWith(TEXT("#")))
+		{
+			continue;
+		}
+
+		const FString& Statement = Tokens[0];
+		bool bValid = true;
+
+		if (Statement == TEXT("v"))
+		{
+			FVector Position;
+			bValid = ParseVector(Tokens, 1, Position);
+			Positions.Add(Position);
+		}
+		else if (Statement == TEXT("f"))
+		{
+			bValid = Tokens.Num() >= 4 && CurrentMaterial != INDEX_NONE;
+			if (bValid && Instances.Num() == 0)
+			{
+				BeginInstance(TEXT("Default"));
+			}
+
+			for (int32 FanIndex = 2; bValid && FanIndex + 1 < Tokens.Num(); ++FanIndex)
+			{
+				const int32 Corners[3] = { 1, FanIndex, FanIndex + 1 };
+				for (int32 Corner : Corners)
+				{
+					const int32 VertexIndex = FCString::Atoi(*Tokens[Corner]) - 1;
+					bValid &= Positions.IsValidIndex(VertexIndex);
+					Indices.Add(bValid ? uint32(VertexIndex) : 0u);
+				}
+
+				const FCausticsMaterial& Material = Materials[CurrentMaterial];
+				FCausticsInstance& Instance = Instances.Last();
+				Instance.Mask |= Material.BlendingMode == ECausticsBlendMode::Opaque
+					? uint8(ECausticsInstanceMask::Opaque | ECausticsInstanceMask::Shadow)
+					: uint8(ECausticsInstanceMask::Translucent);
+				Instance.NumTriangles++;
+
+				TriangleMaterials.Add(CurrentMaterial);
+				TriangleInstances.Add(Instances.Num() - 1);
+			}
+		}
+		else if (Statement == TEXT("object"))
+		{
+			bValid = Tokens.Num() >= 2;
+			BeginInstance(bValid ? Tokens[1] : FString());
+		}
+		else if (Statement == TEXT("usemtl"))
+		{
+			CurrentMaterial = Tokens.Num() >= 2 ? FindMaterial(Tokens[1]) : INDEX_NONE;
+			bValid = CurrentMaterial != INDEX_NONE;
+		}
+		else if (Statement == TEXT("material"))
+		{
+			FCausticsMaterial Material;
+			bValid = Tokens.Num() >= 6 && ParseVector(Tokens, 3, Material.BaseColor);
+			if (bValid)
+			{
+				Material.Name = Tokens[1];
+				Material.BlendingMode = Tokens[2] == TEXT("translucent") ? ECausticsBlendMode::Translucent : ECausticsBlendMode::Opaque;
+
+				const FOptionalArguments Optional(Tokens, 6);
+				Optional.GetFloat(TEXT("opacity"), Material.Opacity);
+				Optional.GetFloat(TEXT("roughness"), Material.Roughness);
+				Optional.GetFloat(TEXT("specular"), Material.Specular);
+				Optional.GetFloat(TEXT("absorption"), Material.AbsorptionCoefficient);
+				Optional.GetVector(TEXT("emissive"), Material.Emissive);
+
+				const int32 ExistingIndex = FindMaterial(Material.Name);
+				if (ExistingIndex != INDEX_NONE)
+				{
+					Materials[ExistingIndex] = Material;
+				}
+				else
+				{
+					Materials.Add(Material);
+				}
+			}
+		}
+		else if (Statement == TEXT("light"))
+		{
+			FCausticsLight Light;
+			bValid = ParseLight(Tokens, Light);
+			if (bValid)
+			{
+				Lights.Add(Light);
+			}
+		}
+		else if (Statement == TEXT("camera"))
+		{
+			bValid = ParseVector(Tokens, 1, Camera.Position)
+				&& ParseVector(Tokens, 4, Camera.LookAt)
+				&& ParseFloat(Tokens, 7, Camera.FieldOfViewDegrees);
+		}
+		else
+		{
+			bValid = false;
+		}
+
+		if (!bValid)
+		{
+			UE_LOG(LogCausticsReference, Error, TEXT("%s(%d): invalid statement '%s'"), Filename, LineIndex + 1, *Lines[LineIndex]);
+			return false;
+		}
+	}
+
+	UE_LOG(LogCausticsReference, Display, TEXT("Loaded %s: %d triangles, %d instances, %d materials, %d lights"),
+		Filename, NumTriangles(), Instances.Num(), Materials.Num(), Lights.Num());
+	return NumTriangles() > 0;
+}
+
+void FCausticsScene::GetTranslucentInstanceBounds(TArray<FVector4>& OutBounds) const
+{
+	for (const FCausticsInstance& Instance : Instances)
+	{
+		if ((Instance.Mask & ECausticsInstanceMask::Translucent) == 0 || Instance.NumTriangles == 0)
+		{
+			continue;
+		}
+
+		FBox Box(ForceInit);
+		for (int32 TriangleIndex = Instance.FirstTriangle; TriangleIndex < Instance.FirstTriangle + Instance.NumTriangles; ++TriangleIndex)
+		{
+			FVector V0, V1, V2;
+			GetTriangle(TriangleIndex, V0, V1, V2);
+			Box += V0;
+			Box += V1;
+			Box += V2;
+		}
+
+		const FBoxSphereBounds Bounds(Box);
+		OutBounds.Add(FVector4(Bounds.Origin, Bounds.SphereRadius));
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Mirrors RAY_TRACING_MASK_* from RayTracingDefinitions.h
+namespace ECausticsInstanceMask
+{
+	enum Type : uint8
+	{
+		Opaque = 0x01,
+		Translucent = 0x02,
+		Shadow = 0x08,
+		All = 0xFF,
+	};
+}
+
+// Mirrors RAY_TRACING_BLEND_MODE_* from RayTracingHitGroupCommon.ush
+namespace ECausticsBlendMode
+{
+	enum Type : uint32
+	{
+		Opaque = 0,
+		AlphaComposite = 1,
+		Translucent = 2,
+		Additive = 3,
+		Modulate = 4,
+	};
+}
+
+// Mirrors LIGHT_TYPE_* from LightShaderParameters.ush
+namespace ECausticsLightType
+{
+	enum Type : int32
+	{
+		Directional = 0,
+		Point = 1,
+		Spot = 2,
+		Rect = 3,
+		Max = 4,
+	};
+}
+
+struct FCausticsMaterial
+{
+	FString Name;
+	uint32 BlendingMode = ECausticsBlendMode::Opaque;
+	FVector BaseColor = FVector(0.5f, 0.5f, 0.5f);
+	FVector Emissive = FVector::ZeroVector;
+	float Opacity = 1.0f;
+	float Roughness = 0.5f;
+	float Specular = 0.5f;
+
+	/** Stored in the payload Ior slot, which the LHPC materials use as their absorption coefficient. */
+	float AbsorptionCoefficient = 0.0f;
+};
+
+/** CPU counterpart of FRTLightingData. Direction follows the shader convention and points back towards the light. */
+struct FCausticsLight
+{
+	int32 Type = ECausticsLightType::Point;
+	FVector LightPosition = FVector::ZeroVector;
+	float InvRadius = 0.0f;
+	FVector Direction = FVector(0.0f, 0.0f, 1.0f);
+	FVector LightColor = FVector(1.0f, 1.0f, 1.0f);
+	FVector Tangent = FVector(1.0f, 0.0f, 0.0f);
+	float SourceRadius = 0.0f;
+	float SourceLength = 0.0f;
+	FVector2D SpotAngles = FVector2D(-2.0f, 1.0f);
+};
+
+struct FCausticsCamera
+{
+	FVector Position = FVector(-500.0f, 0.0f, 200.0f);
+	FVector LookAt = FVector::ZeroVector;
+	FVector Up = FVector(0.0f, 0.0f, 1.0f);
+	float FieldOfViewDegrees = 90.0f;
+};
+
+/** One ray tracing instance: a contiguous triangle range sharing an instance mask, as gathered by GatherRayTracingWorldInstances. */
+struct FCausticsInstance
+{
+	FString Name;
+	int32 FirstTriangle = 0;
+	int32 NumTriangles = 0;
+	uint8 Mask = 0;
+};
+
+/**
+ * Scene for the CPU reference renderer, loaded from a plain text file. One statement per line, '#' starts a comment:
+ *
+ *   camera <px py pz> <tx ty tz> <fov degrees>
+ *   material <name> opaque|translucent <r g b> [opacity o] [roughness r] [specular s] [absorption a] [emissive r g b]
+ *   light directional <dx dy dz> <r g b> [radius s]
+ *   light point <px py pz> <r g b> [radius s] [attenuation d]
+ *   light spot <px py pz> <dx dy dz> <r g b> <outer cone degrees> [radius s] [attenuation d]
+ *   light rect <px py pz> <dx dy dz> <tx ty tz> <r g b> <width> <height> [attenuation d]
+ *   object <name>
+ *   usemtl <name>
+ *   v <x y z>
+ *   f <i j k ...>
+ *
+ * Light directions are the direction the light travels in, as for the forward vector of a light actor.
+ * Vertex indices are 1-based and global like in Wavefront OBJ, polygons are fan triangulated and faces wind
+ * so that cross(V1 - V0, V2 - V0) points outwards.
+ */
+class FCausticsScene
+{
+public:
+	bool LoadFromFile(const TCHAR* Filename);
+
+	int32 NumTriangles() const
+	{
+		return TriangleMaterials.Num();
+	}
+
+	void GetTriangle(int32 TriangleIndex, FVector& OutV0, FVector& OutV1, FVector& OutV2) const
+	{
+		OutV0 = Positions[Indices[TriangleIndex * 3 + 0]];
+		OutV1 = Positions[Indices[TriangleIndex * 3 + 1]];
+		OutV2 = Positions[Indices[TriangleIndex * 3 + 2]];
+	}
+
+	const FCausticsMaterial& GetTriangleMaterial(int32 TriangleIndex) const
+	{
+		return Materials[TriangleMaterials[TriangleIndex]];
+	}
+
+	/** Bounding spheres of the instances with the translucent mask, center in xyz and radius in w, like the primitive bounds of the renderer. */
+	void GetTranslucentInstanceBounds(TArray<FVector4>& OutBounds) const;
+
+	FCausticsCamera Camera;
+	TArray<FCausticsMaterial> Materials;
+	TArray<FCausticsLight> Lights;
+	TArray<FCausticsInstance> Instances;
+
+	TArray<FVector> Positions;
+	TArray<uint32> Indices;
+	TArray<int32> TriangleMaterials;
+	TArray<int32> TriangleInstances;
+
+private:
+	int32 FindMaterial(const FString& Name) const;
+	void BeginInstance(const FString& Name);
+};
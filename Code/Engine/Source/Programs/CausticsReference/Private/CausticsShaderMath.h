@@ -0,0 +1,191 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CausticsRandomSequence.h"
+
+/////////////////////////////////////////////////////////////////////////////////
+// CPU counterparts of the HLSL helpers used by RayTracingCaustics.usf.
+// Names and argument order follow Common.ush, BRDF.ush, MonteCarlo.ush and Utils.ush
+// so that the two implementations can be diffed side by side.
+/////////////////////////////////////////////////////////////////////////////////
+
+static const float MaxHalfFloat = 65504.0f;
+
+FORCEINLINE float Saturate(float Value)
+{
+	return FMath::Clamp(Value, 0.0f, 1.0f);
+}
+
+FORCEINLINE FVector ClampToHalfFloatRange(const FVector& Value)
+{
+	return FVector(
+		FMath::Clamp(Value.X, 0.0f, MaxHalfFloat),
+		FMath::Clamp(Value.Y, 0.0f, MaxHalfFloat),
+		FMath::Clamp(Value.Z, 0.0f, MaxHalfFloat));
+}
+
+FORCEINLINE FLinearColor ClampToHalfFloatRange(const FLinearColor& Value)
+{
+	return FLinearColor(
+		FMath::Clamp(Value.R, 0.0f, MaxHalfFloat),
+		FMath::Clamp(Value.G, 0.0f, MaxHalfFloat),
+		FMath::Clamp(Value.B, 0.0f, MaxHalfFloat),
+		FMath::Clamp(Value.A, 0.0f, MaxHalfFloat));
+}
+
+FORCEINLINE float DielectricSpecularToF0(float Specular)
+{
+	return 0.08f * Specular;
+}
+
+FORCEINLINE float DielectricF0ToIor(float F0)
+{
+	return 2.0f / (1.0f - FMath::Sqrt(F0)) - 1.0f;
+}
+
+// HLSL refract(): returns a zero vector on total internal reflection.
+FORCEINLINE FVector HLSLRefract(const FVector& I, const FVector& N, float Eta)
+{
+	const float NoI = N | I;
+	const float K = 1.0f - Eta * Eta * (1.0f - NoI * NoI);
+	return K < 0.0f ? FVector::ZeroVector : I * Eta - N * (Eta * NoI + FMath::Sqrt(K));
+}
+
+// HLSL reflect()
+FORCEINLINE FVector HLSLReflect(const FVector& I, const FVector& N)
+{
+	return I - N * (2.0f * (N | I));
+}
+
+// GetTangentBasis() from MonteCarlo.ush, applied as TangentToWorld().
+FORCEINLINE FVector TangentToWorld(const FVector& Vec, const FVector& TangentZ)
+{
+	const float Sign = TangentZ.Z >= 0.0f ? 1.0f : -1.0f;
+	const float A = -1.0f / (Sign + TangentZ.Z);
+	const float B = TangentZ.X * TangentZ.Y * A;
+	const FVector TangentX(1.0f + Sign * A * FMath::Square(TangentZ.X), Sign * B, -Sign * TangentZ.X);
+	const FVector TangentY(B, Sign + A * FMath::Square(TangentZ.Y), -TangentZ.Y);
+	return TangentX * Vec.X + TangentY * Vec.Y + TangentZ * Vec.Z;
+}
+
+// Returns the half vector in .xyz and its pdf in .w
+FORCEINLINE FVector4 ImportanceSampleGGX(const FVector2D& E, float A2)
+{
+	const float Phi = 2.0f * PI * E.X;
+	const float CosTheta = FMath::Sqrt((1.0f - E.Y) / (1.0f + (A2 - 1.0f) * E.Y));
+	const float SinTheta = FMath::Sqrt(1.0f - CosTheta * CosTheta);
+
+	const FVector H(SinTheta * FMath::Cos(Phi), SinTheta * FMath::Sin(Phi), CosTheta);
+
+	const float D0 = (CosTheta * A2 - CosTheta) * CosTheta + 1.0f;
+	const float D = A2 / (PI * D0 * D0);
+	return FVector4(H, D * CosTheta);
+}
+
+FORCEINLINE FVector4 UniformSampleSphere(const FVector2D& E)
+{
+	const float Phi = 2.0f * PI * E.X;
+	const float CosTheta = 1.0f - 2.0f * E.Y;
+	const float SinTheta = FMath::Sqrt(1.0f - CosTheta * CosTheta);
+	return FVector4(FVector(SinTheta * FMath::Cos(Phi), SinTheta * FMath::Sin(Phi), CosTheta), 1.0f / (4.0f * PI));
+}
+
+FORCEINLINE FVector2D UniformSampleDiskConcentric(const FVector2D& E)
+{
+	const FVector2D P = E * 2.0f - 1.0f;
+	if (P.X == 0.0f && P.Y == 0.0f)
+	{
+		return FVector2D(0.0f, 0.0f);
+	}
+
+	float Radius;
+	float Phi;
+	if (FMath::Abs(P.X) > FMath::Abs(P.Y))
+	{
+		Radius = P.X;
+		Phi = (PI / 4.0f) * (P.Y / P.X);
+	}
+	else
+	{
+		Radius = P.Y;
+		Phi = (PI / 2.0f) - (PI / 4.0f) * (P.X / P.Y);
+	}
+	return FVector2D(Radius * FMath::Cos(Phi), Radius * FMath::Sin(Phi));
+}
+
+/*********************************************/
+// Utils.ush
+
+// \delta(Diffcolor) = 1 - DiffColor
+FORCEINLINE FVector ColorInvert(const FVector& Color)
+{
+	return FVector(1.0f, 1.0f, 1.0f) - Color;
+}
+
+// Calculating the Volumetric Absorption
+FORCEINLINE FVector RayAbsorb(const FVector& AbsorbColor, float HitT, float Opacity)
+{
+	const FVector DeltaColor = ColorInvert(AbsorbColor);
+	return DeltaColor * (1.0f - FMath::Exp(-Opacity * HitT * 0.00075f));
+}
+
+// Rough Transparency
+// Generating the Bent Normal $N_b$, returns the pdf of the sampled micro normal.
+// RandSequence is taken by value like the HLSL version, so the caller's sequence does not advance.
+FORCEINLINE float BiasNormal(FCausticsRandomSequence RandSequence, FVector& MicroNormal, float Roughness)
+{
+	const FVector SmoothNormal = MicroNormal;
+	const FVector2D E = RandomSequence_GenerateSample2D(RandSequence);
+	const float A = Roughness * Roughness;
+	const FVector4 DirectionTangent = ImportanceSampleGGX(E, A * A);
+	MicroNormal = TangentToWorld(FVector(DirectionTangent.X, DirectionTangent.Y, DirectionTangent.Z), MicroNormal);
+
+	if ((SmoothNormal | MicroNormal) < 0.0f)
+	{
+		MicroNormal = MicroNormal - SmoothNormal * (2.0f * (SmoothNormal | MicroNormal));
+	}
+	return DirectionTangent.W;
+}
+
+FORCEINLINE float FresnelDielectric(float Eta, float IoH, float ToH)
+{
+	const float Rs = FMath::Square((Eta * IoH - ToH) / (Eta * IoH + ToH));
+	const float Rp = FMath::Square((Eta * ToH - IoH) / (Eta * ToH + IoH));
+	return (Rs + Rp) / 2.0f;
+}
+
+FORCEINLINE float CalcNoT(float CosTheta1, float N1, float N2)
+{
+	const float SinTheta1Squared = 1.0f - CosTheta1 * CosTheta1;
+	const float SinTheta2Squared = (SinTheta1Squared * N1 * N1) / (N2 * N2);
+	const float CosTheta2Squared = 1.0f - SinTheta2Squared;
+	return CosTheta2Squared > 0.0f ? FMath::Sqrt(CosTheta2Squared) : 0.0f;
+}
+
+FORCEINLINE FVector RefractRay(const FVector& RayDirection, FVector N, float Ior, bool bIsEntering, float& PathThroughput)
+{
+	const FVector V = -RayDirection;
+	float NoV = N | V;
+
+	if (NoV < 0.0f)
+	{
+		NoV = -NoV;
+		N = -N;
+		bIsEntering = true;
+	}
+
+	const float N1 = bIsEntering ? 1.0f : Ior;
+	const float N2 = bIsEntering ? Ior : 1.0f;
+	const float Eta = N1 / N2;
+	const float NoT = CalcNoT(NoV, N1, N2);
+	const float Fr = FresnelDielectric(Eta, NoV, NoT);
+	const FVector T = HLSLRefract(RayDirection, N, Eta);
+	if (!T.IsZero())
+	{
+		PathThroughput *= 1.0f - Fr;
+		return T;
+	}
+
+	// Handle total internal reflection
+	return HLSLReflect(-V, N);
+}
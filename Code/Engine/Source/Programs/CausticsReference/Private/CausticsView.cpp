@@ -0,0 +1,79 @@
+#include "CausticsView.h"
+#include "CausticsScene.h"
+
+namespace
+{
+	/** HLSL float to uint conversion: NaN and negative values become 0. Large values saturate to what fits in an FIntPoint. */
+	int32 FloatToUint(float Value)
+	{
+		return Value > 0.0f ? int32(FMath::Min(Value, 2147483520.0f)) : 0;
+	}
+}
+
+void FCausticsView::Init(const FCausticsCamera& Camera, FIntPoint InBufferSize, uint32 InStateFrameIndex)
+{
+	static const float NearClippingPlane = 10.0f;
+
+	BufferSize = InBufferSize;
+	StateFrameIndex = InStateFrameIndex;
+	WorldCameraOrigin = Camera.Position;
+	ViewForward = (Camera.LookAt - Camera.Position).GetSafeNormal();
+	ScreenPositionScaleBias = FVector4(0.5f, -0.5f, 0.5f, 0.5f);
+
+	const FMatrix ViewMatrix = FLookAtMatrix(Camera.Position, Camera.LookAt, Camera.Up);
+	const float HalfFOV = FMath::Clamp(Camera.FieldOfViewDegrees, 1.0f, 170.0f) * 0.5f * PI / 180.0f;
+	const FMatrix ProjectionMatrix = FReversedZPerspectiveMatrix(HalfFOV, float(BufferSize.X), float(BufferSize.Y), NearClippingPlane);
+
+	// Angle subtended by one pixel, as set up for ray cones in SceneRendering.cpp
+	EyeToPixelSpreadAngle = FMath::Atan(2.0f * FMath::Tan(HalfFOV) / BufferSize.X);
+
+	WorldToClip = ViewMatrix * ProjectionMatrix;
+	ClipToWorld = WorldToClip.Inverse();
+}
+
+FIntPoint FCausticsView::GetPixelCoord(FIntPoint DispatchThreadId, int32 UpscaleFactor) const
+{
+	const uint32 UpscaleFactorPow2 = UpscaleFactor * UpscaleFactor;
+	const uint32 SubPixelId = StateFrameIndex & (UpscaleFactorPow2 - 1);
+	return DispatchThreadId * UpscaleFactor + FIntPoint(SubPixelId & (UpscaleFactor - 1), SubPixelId / UpscaleFactor);
+}
+
+FCausticsRay FCausticsView::CreatePrimaryRay(const FVector2D& UV) const
+{
+	const FVector2D ScreenPosition(
+		(UV.X - ScreenPositionScaleBias.W) / ScreenPositionScaleBias.X,
+		(UV.Y - ScreenPositionScaleBias.Z) / ScreenPositionScaleBias.Y);
+
+	// Reversed Z: device depth 1 is the near plane
+	const FVector4 NearPoint = ClipToWorld.TransformFVector4(FVector4(ScreenPosition.X, ScreenPosition.Y, 1.0f, 1.0f));
+	const FVector4 FarPoint = ClipToWorld.TransformFVector4(FVector4(ScreenPosition.X, ScreenPosition.Y, 0.01f, 1.0f));
+	const FVector Near = FVector(NearPoint.X, NearPoint.Y, NearPoint.Z) / NearPoint.W;
+	const FVector Far = FVector(FarPoint.X, FarPoint.Y, FarPoint.Z) / FarPoint.W;
+
+	FCausticsRay Ray;
+	Ray.Origin = Near;
+	Ray.Direction = (Far - Near).GetSafeNormal();
+	Ray.TMin = 0.0f;
+	Ray.TMax = 1e27f;
+	return Ray;
+}
+
+FIntPoint FCausticsView::GenerateThreadId(const FVector& Position, int32 UpscaleFactor) const
+{
+	const FVector4 ClipPosition = WorldToClip.TransformFVector4(FVector4(Position, 1.0f));
+	if (ClipPosition.W > 0.0f)
+	{
+		const FVector2D ScreenPosition(ClipPosition.X / ClipPosition.W, ClipPosition.Y / ClipPosition.W);
+		const FVector2D UV(
+			ScreenPosition.X * ScreenPositionScaleBias.X + ScreenPositionScaleBias.W,
+			ScreenPosition.Y * ScreenPositionScaleBias.Y + ScreenPositionScaleBias.Z);
+		const FVector2D PixelCoord(UV.X * BufferSize.X - 0.5f, UV.Y * BufferSize.Y - 0.5f);
+
+		const uint32 UpscaleFactorPow2 = UpscaleFactor * UpscaleFactor;
+		const uint32 SubPixelId = StateFrameIndex & (UpscaleFactorPow2 - 1);
+		return FIntPoint(
+			FloatToUint(FMath::FloorToFloat((PixelCoord.X - float(SubPixelId & (UpscaleFactor - 1))) / UpscaleFactor + 0.5f)),
+			FloatToUint(FMath::FloorToFloat((PixelCoord.Y - float(SubPixelId / UpscaleFactor)) / UpscaleFactor + 0.5f)));
+	}
+	return FIntPoint(0, 0);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CausticsBVH.h"
+
+struct FCausticsCamera;
+
+/**
+ * The subset of FViewUniformShaderParameters read by the caustics ray generation shader,
+ * for a single view covering the whole buffer (ViewRectMin = 0).
+ */
+struct FCausticsView
+{
+	void Init(const FCausticsCamera& Camera, FIntPoint InBufferSize, uint32 InStateFrameIndex);
+
+	/** RayTracingCommon.ush */
+	FIntPoint GetPixelCoord(FIntPoint DispatchThreadId, int32 UpscaleFactor) const;
+	FCausticsRay CreatePrimaryRay(const FVector2D& UV) const;
+
+	/**
+	 * GenerateThreadId() from Utils.ush: projects a world position to the dispatch thread whose jittered sample pixel is the nearest.
+	 * The float to uint conversion saturates like on the GPU, so points left of or above the view land on the
+	 * first column or row and points behind the camera land on (0, 0).
+	 */
+	FIntPoint GenerateThreadId(const FVector& Position, int32 UpscaleFactor) const;
+
+	FVector2D GetInvBufferSize() const
+	{
+		return FVector2D(1.0f / BufferSize.X, 1.0f / BufferSize.Y);
+	}
+
+	FIntPoint BufferSize;
+	FMatrix WorldToClip;
+	FMatrix ClipToWorld;
+	FVector WorldCameraOrigin;
+	FVector ViewForward;
+	float EyeToPixelSpreadAngle;
+	FVector4 ScreenPositionScaleBias;
+	uint32 StateFrameIndex;
+};
@@ -0,0 +1,13 @@
+#include "CausticsWavefront.h"
+
+const TCHAR* GetCausticsWavefrontStageName(ECausticsWavefrontStage::Type Stage)
+{
+	switch (Stage)
+	{
+	case ECausticsWavefrontStage::Occlusion:	return TEXT("Occlusion");
+	case ECausticsWavefrontStage::Entry:		return TEXT("Entry");
+	case ECausticsWavefrontStage::Exit:			return TEXT("Exit");
+	case ECausticsWavefrontStage::Receiver:		return TEXT("Receiver");
+	default:									return TEXT("Unknown");
+	}
+}
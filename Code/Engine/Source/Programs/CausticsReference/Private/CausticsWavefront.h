@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CausticsRandomSequence.h"
+
+/////////////////////////////////////////////////////////////////////////////////
+// CPU counterparts of RayTracingCausticsWavefront.ush.
+// With r.RayTracing.Caustics.Wavefront the screen space caustics run in four stages, each appending the paths still
+// alive to a queue the next stage reads, so that every dispatch only traces live rays. The CPU port runs the same
+// stages and counts how many threads of each dispatch have a path to trace.
+/////////////////////////////////////////////////////////////////////////////////
+
+/** Mirrors CAUSTICS_WAVEFRONT_STAGE_*, minus one. */
+namespace ECausticsWavefrontStage
+{
+	enum Type
+	{
+		Occlusion,
+		Entry,
+		Exit,
+		Receiver,
+		Num,
+	};
+}
+
+const TCHAR* GetCausticsWavefrontStageName(ECausticsWavefrontStage::Type Stage);
+
+/** Mirrors FCausticsEntryQueueItem, without the ray cone which the CPU port omits. */
+struct FCausticsEntryQueueItem
+{
+	FIntPoint DispatchThreadId = FIntPoint::ZeroValue;
+	uint32 PathSeed = 0;
+	int32 NumTransmissionSamples = 1;
+	float LightWeight = 1.0f;
+	FVector OcclusionOrigin = FVector::ZeroVector;
+	float OcclusionTMax = 0.0f;
+	FVector OcclusionDirection = FVector::ZeroVector;
+	float TranslucentHitT = 0.0f;
+
+	/** Stands in for the G-buffer roughness the shader reads at the pixel, the primary hit of the CPU port. */
+	float ReceiverRoughness = 0.0f;
+};
+
+/** Mirrors FCausticsExitQueueItem, without the ray cone and depth which the CPU port omits. */
+struct FCausticsExitQueueItem
+{
+	FIntPoint DispatchThreadId = FIntPoint::ZeroValue;
+	uint32 PathSeed = 0;
+	int32 NumTransmissionSamples = 1;
+	FVector IncidentRadiance = FVector::ZeroVector;
+	FVector ExitOrigin = FVector::ZeroVector;
+	float ExitTMax = 0.0f;
+	FVector InsideDirection = FVector::ZeroVector;
+	float ExitRoughness = 0.0f;
+	FVector ExitNormal = FVector::ZeroVector;
+	float ExitSpecular = 0.0f;
+	float ExitOpacity = 0.0f;
+};
+
+/** Mirrors FCausticsReceiverQueueItem. */
+struct FCausticsReceiverQueueItem
+{
+	FIntPoint ThreadId = FIntPoint::ZeroValue;
+	FVector HitPosition = FVector::ZeroVector;
+	float TransmissionHitT = 0.0f;
+	FLinearColor Color = FLinearColor::Transparent;
+};
+
+/** GetCausticsPathSeed(): seed of the path a pixel traces towards the LightIteration-th light of its light loop. */
+FORCEINLINE uint32 GetCausticsPathSeed(uint32 LinearIndex, uint32 LightIteration)
+{
+	return StrongIntegerHash(LinearIndex ^ StrongIntegerHash(LightIteration));
+}
+
+/** GetCausticsWavefrontTimeSeed(), Stage counts from CAUSTICS_WAVEFRONT_STAGE_OCCLUSION. */
+FORCEINLINE uint32 GetCausticsWavefrontTimeSeed(uint32 StateFrameIndex, uint32 Stage)
+{
+	return StateFrameIndex * (ECausticsWavefrontStage::Num + 1) + Stage;
+}
+
+/** Occupancy of the dispatch of one stage. */
+struct FCausticsWavefrontStageStats
+{
+	/** Threads the GPU dispatches, the capacity of the queue read past the first stage. */
+	int64 NumThreads = 0;
+
+	/** Threads that have a path to trace. */
+	int64 NumLiveThreads = 0;
+
+	uint64 NumRays = 0;
+
+	/** Paths appended to the queue of the next stage, including the NumDropped ones past its capacity. */
+	int64 NumAppended = 0;
+	int64 NumDropped = 0;
+};
+
+/**
+ * The queue compaction of AllocateCausticsQueueItem(): the items every chunk of a stage appended, in dispatch order,
+ * up to the capacity of the queue. The GPU appends in whatever order the threads arrive in, the CPU port keeps the
+ * dispatch order so that the result does not depend on the worker threads.
+ */
+template<typename ItemType>
+void CompactCausticsQueue(const TArray<TArray<ItemType>>& ChunkItems, int32 Capacity, TArray<ItemType>& OutQueue, FCausticsWavefrontStageStats& Stats)
+{
+	OutQueue.Reset();
+	for (const TArray<ItemType>& Items : ChunkItems)
+	{
+		Stats.NumAppended += Items.Num();
+		const int32 NumKept = FMath::Clamp(Capacity - OutQueue.Num(), 0, Items.Num());
+		OutQueue.Append(Items.GetData(), NumKept);
+	}
+	Stats.NumDropped = Stats.NumAppended - OutQueue.Num();
+}
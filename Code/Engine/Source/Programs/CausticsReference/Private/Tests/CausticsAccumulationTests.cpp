@@ -0,0 +1,121 @@
+#include "CausticsAccumulation.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCausticsAccumulationRoundTripTest, "CausticsReference.Accumulation.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FCausticsAccumulationRoundTripTest::RunTest(const FString& Parameters)
+{
+	// A single value comes back within half a step of the fixed point
+	const float Scales[] = { 1.0f, DefaultCausticsAccumulationScale, 2048.0f };
+	const float Values[] = { 0.0f, 1.0f, -1.0f, 0.001f, -0.3f, 3.75f, 1000.0f, -4095.5f };
+	for (float Scale : Scales)
+	{
+		for (float Value : Values)
+		{
+			const float Decoded = DecodeCausticsAccumulation(EncodeCausticsAccumulation(Value, Scale), Scale);
+			TestEqual(*FString::Printf(TEXT("Decoded %f at scale %f"), Value, Scale), Decoded, Value, 0.5f / Scale + KINDA_SMALL_NUMBER);
+		}
+	}
+
+	// Sums of signed splats resolve to the sum of the values, whatever the order of the splats
+	const FIntPoint Extent(3, 2);
+	const float Scale = DefaultCausticsAccumulationScale;
+	const FIntPoint ThreadId(1, 1);
+	const TArray<FLinearColor> Splats =
+	{
+		FLinearColor(0.25f, 1.5f, 0.0f, 1.0f),
+		FLinearColor(-0.125f, 2.0f, 0.001f, 1.0f),
+		FLinearColor(3.0f, -1.25f, 0.5f, 1.0f),
+	};
+
+	TArray<uint32> Forward;
+	TArray<uint32> Backward;
+	Forward.SetNumZeroed(Extent.X * Extent.Y * CausticsAccumulationChannels);
+	Backward.SetNumZeroed(Extent.X * Extent.Y * CausticsAccumulationChannels);
+	FLinearColor Expected(0.0f, 0.0f, 0.0f, 0.0f);
+	for (int32 SplatIndex = 0; SplatIndex < Splats.Num(); ++SplatIndex)
+	{
+		AccumulateCausticsColor(Forward, Extent, Scale, ThreadId, Splats[SplatIndex]);
+		AccumulateCausticsColor(Backward, Extent, Scale, ThreadId, Splats[Splats.Num() - 1 - SplatIndex]);
+		Expected += Splats[SplatIndex];
+	}
+	TestTrue(TEXT("Accumulation is independent of the splat order"), Forward == Backward);
+
+	// Splats outside of the buffer are dropped
+	AccumulateCausticsColor(Forward, Extent, Scale, FIntPoint(-1, 0), FLinearColor::White);
+	AccumulateCausticsColor(Forward, Extent, Scale, FIntPoint(0, Extent.Y), FLinearColor::White);
+	TestTrue(TEXT("Splats outside of the buffer are dropped"), Forward == Backward);
+
+	TArray<FLinearColor> Resolved;
+	ResolveCausticsAccumulation(Forward, Extent, Scale, Resolved);
+	const float Tolerance = Splats.Num() * 0.5f / Scale;
+	const FLinearColor& Pixel = Resolved[ThreadId.Y * Extent.X + ThreadId.X];
+	TestEqual(TEXT("Resolved red"), Pixel.R, Expected.R, Tolerance);
+	TestEqual(TEXT("Resolved green"), Pixel.G, Expected.G, Tolerance);
+	TestEqual(TEXT("Resolved blue"), Pixel.B, Expected.B, Tolerance);
+	TestEqual(TEXT("Resolved alpha"), Pixel.A, Expected.A, Tolerance);
+	for (int32 PixelIndex = 0; PixelIndex < Resolved.Num(); ++PixelIndex)
+	{
+		if (PixelIndex != ThreadId.Y * Extent.X + ThreadId.X)
+		{
+			TestTrue(*FString::Printf(TEXT("Pixel %d without splats is black"), PixelIndex), Resolved[PixelIndex] == FLinearColor(0.0f, 0.0f, 0.0f, 0.0f));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCausticsAccumulationClampTest, "CausticsReference.Accumulation.Clamp", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FCausticsAccumulationClampTest::RunTest(const FString& Parameters)
+{
+	const int32 MaxEncodedValue = 8388608;
+	TestEqual(TEXT("CausticsAccumulationMaxEncodedValue is 2^23"), CausticsAccumulationMaxEncodedValue, float(1 << 23));
+
+	// Contributions are clamped to 2^23 steps of the scale, whatever the scale
+	const float Scales[] = { 1.0f, DefaultCausticsAccumulationScale };
+	for (float Scale : Scales)
+	{
+		const float MaxValue = MaxEncodedValue / Scale;
+		TestEqual(TEXT("The largest contribution is kept"), int32(EncodeCausticsAccumulation(MaxValue, Scale)), MaxEncodedValue);
+		TestEqual(TEXT("Larger contributions are clamped"), int32(EncodeCausticsAccumulation(MaxValue * 2.0f, Scale)), MaxEncodedValue);
+		TestEqual(TEXT("Negative contributions are clamped"), int32(EncodeCausticsAccumulation(-MaxValue * 2.0f, Scale)), -MaxEncodedValue);
+		TestEqual(TEXT("Huge contributions are clamped"), int32(EncodeCausticsAccumulation(1e30f, Scale)), MaxEncodedValue);
+		TestEqual(TEXT("A clamped contribution decodes to the largest value"), DecodeCausticsAccumulation(EncodeCausticsAccumulation(1e30f, Scale), Scale), MaxValue);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCausticsAccumulationOverflowTest, "CausticsReference.Accumulation.Overflow", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FCausticsAccumulationOverflowTest::RunTest(const FString& Parameters)
+{
+	const FIntPoint Extent(1, 1);
+	const float Scale = 1.0f;
+	const float MaxValue = CausticsAccumulationMaxEncodedValue;
+
+	// 255 clamped contributions of either sign fit in a channel
+	TArray<uint32> Accumulation;
+	Accumulation.SetNumZeroed(CausticsAccumulationChannels);
+	for (int32 SplatIndex = 0; SplatIndex < 255; ++SplatIndex)
+	{
+		AccumulateCausticsColor(Accumulation, Extent, Scale, FIntPoint(0, 0), FLinearColor(MaxValue, -MaxValue, 2.0f * MaxValue, 0.0f));
+	}
+
+	TArray<FLinearColor> Resolved;
+	ResolveCausticsAccumulation(Accumulation, Extent, Scale, Resolved);
+	TestEqual(TEXT("255 positive contributions"), Resolved[0].R, 255.0f * MaxValue);
+	TestEqual(TEXT("255 negative contributions"), Resolved[0].G, -255.0f * MaxValue);
+	TestEqual(TEXT("255 clamped contributions"), Resolved[0].B, 255.0f * MaxValue);
+
+	// The 256th wraps around to the most negative value, which is why single contributions are clamped
+	AccumulateCausticsColor(Accumulation, Extent, Scale, FIntPoint(0, 0), FLinearColor(MaxValue, -MaxValue, 0.0f, 0.0f));
+	ResolveCausticsAccumulation(Accumulation, Extent, Scale, Resolved);
+	TestEqual(TEXT("256 positive contributions wrap around"), int32(Accumulation[0]), MIN_int32);
+	TestTrue(TEXT("256 positive contributions resolve negative"), Resolved[0].R < 0.0f);
+	TestEqual(TEXT("256 negative contributions still fit"), int32(Accumulation[1]), MIN_int32);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
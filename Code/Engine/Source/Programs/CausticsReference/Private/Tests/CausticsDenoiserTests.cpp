@@ -0,0 +1,95 @@
+#include "CausticsDenoiser.h"
+#include "CausticsImage.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/**
+	 * Fixed denoiser input: a bright noisy caustic on a floor that steps back in depth, a wall at an angle on the right
+	 * and a corner of sky. The noise is an integer hash so that the input is the same on every platform.
+	 */
+	void MakeCausticsDenoiserTestInput(FIntPoint Size, TArray<FVector4>& OutGuide, TArray<FLinearColor>& OutColor)
+	{
+		OutGuide.SetNumUninitialized(Size.X * Size.Y);
+		OutColor.SetNumUninitialized(Size.X * Size.Y);
+		for (int32 Y = 0; Y < Size.Y; ++Y)
+		{
+			for (int32 X = 0; X < Size.X; ++X)
+			{
+				const int32 Index = Y * Size.X + X;
+
+				const FVector Normal = X < Size.X * 5 / 8 ? FVector(0.0f, 0.0f, 1.0f) : FVector(0.6f, 0.0f, 0.8f);
+				const float Depth = X < 4 && Y < 4 ? 0.0f : (Y < Size.Y * 2 / 3 ? 500.0f + 2.0f * Y : 900.0f);
+				OutGuide[Index] = FVector4(Normal, Depth);
+
+				uint32 Hash = uint32(Index) * 0x9E3779B9u;
+				Hash = (Hash ^ (Hash >> 15)) * 0x85EBCA6Bu;
+				Hash ^= Hash >> 13;
+				const float Noise = float(Hash >> 8) / float(1 << 24);
+
+				const bool bInCaustic = FMath::Square(X - 12) + FMath::Square(Y - 10) <= 36;
+				const float Value = (bInCaustic ? 4.0f : 0.1f) * (0.5f + Noise);
+				OutColor[Index] = FLinearColor(Value, Value * 0.75f, Value * 0.5f, 1.0f);
+			}
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCausticsDenoiserGoldenTest, "CausticsReference.Denoiser.Golden", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FCausticsDenoiserGoldenTest::RunTest(const FString& Parameters)
+{
+	const FIntPoint Size(32, 24);
+	TArray<FVector4> Guide;
+	TArray<FLinearColor> Color;
+	MakeCausticsDenoiserTestInput(Size, Guide, Color);
+
+	FCausticsDenoiserParameters DenoiserParameters;
+	DenoiseCaustics(DenoiserParameters, Size, Guide, Color, true);
+
+	const FString GoldenFilename = FPaths::Combine(FPaths::EngineSourceDir(), TEXT("Programs/CausticsReference/Tests/CausticsDenoiserGolden.pfm"));
+	const FString ResultFilename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CausticsDenoiserGolden.pfm"));
+
+	FIntPoint GoldenSize;
+	TArray<FLinearColor> Golden;
+	bool bMatches = ReadColorPFM(*GoldenFilename, GoldenSize, Golden);
+	if (!bMatches)
+	{
+		AddError(FString::Printf(TEXT("Failed to read %s"), *GoldenFilename));
+	}
+	else if (!TestTrue(TEXT("The reference has the size of the input"), GoldenSize == Size))
+	{
+		bMatches = false;
+	}
+	else
+	{
+		// Leaves room for the differences of FMath::Exp and FMath::Pow between platforms
+		const float RelativeTolerance = 1e-3f;
+		const float AbsoluteTolerance = 1e-5f;
+		for (int32 Index = 0; Index < Golden.Num() && bMatches; ++Index)
+		{
+			for (int32 Channel = 0; Channel < 3; ++Channel)
+			{
+				const float Expected = Golden[Index].Component(Channel);
+				const float Actual = Color[Index].Component(Channel);
+				if (FMath::Abs(Actual - Expected) > AbsoluteTolerance + RelativeTolerance * FMath::Abs(Expected))
+				{
+					AddError(FString::Printf(TEXT("Texel %d,%d channel %d is %f, the reference has %f"), Index % Size.X, Index / Size.X, Channel, Actual, Expected));
+					bMatches = false;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!bMatches && WriteColorPFM(*ResultFilename, Size, Color))
+	{
+		AddInfo(FString::Printf(TEXT("Wrote the result to %s, copy it over the reference if the change is intended"), *ResultFilename));
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,105 @@
+#include "CausticsLightSampling.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Probability the table picks each light with a uniform sample: the entry itself under its threshold, the alias above it. */
+	TArray<double> GetAliasTableSelectionProbabilities(const TArray<FCausticsLightAliasEntry>& Table)
+	{
+		TArray<double> Probabilities;
+		Probabilities.SetNumZeroed(Table.Num());
+		for (int32 EntryIndex = 0; EntryIndex < Table.Num(); ++EntryIndex)
+		{
+			const double Threshold = FMath::Clamp(Table[EntryIndex].Threshold, 0.0f, 1.0f);
+			Probabilities[EntryIndex] += Threshold / Table.Num();
+			Probabilities[Table[EntryIndex].Alias] += (1.0 - Threshold) / Table.Num();
+		}
+		return Probabilities;
+	}
+
+	void TestAliasTable(FAutomationTestBase& Test, const TCHAR* Name, const TArray<float>& Weights)
+	{
+		TArray<FCausticsLightAliasEntry> Table;
+		BuildCausticsLightAliasTable(Weights, Table);
+
+		const int32 NumLights = FMath::Min(Weights.Num(), CausticsLightSamplingMaxLights);
+		if (!Test.TestEqual(*FString::Printf(TEXT("%s: entries"), Name), Table.Num(), NumLights))
+		{
+			return;
+		}
+
+		double TotalWeight = 0.0;
+		for (int32 LightIndex = 0; LightIndex < NumLights; ++LightIndex)
+		{
+			TotalWeight += Weights[LightIndex];
+		}
+
+		const TArray<double> Probabilities = GetAliasTableSelectionProbabilities(Table);
+		for (int32 LightIndex = 0; LightIndex < NumLights; ++LightIndex)
+		{
+			const float Expected = TotalWeight > 0.0 ? float(Weights[LightIndex] / TotalWeight) : 0.0f;
+			Test.TestTrue(*FString::Printf(TEXT("%s: alias of light %d"), Name, LightIndex), Table[LightIndex].Alias >= 0 && Table[LightIndex].Alias < NumLights);
+			Test.TestEqual(*FString::Printf(TEXT("%s: pdf of light %d"), Name, LightIndex), Table[LightIndex].Pdf, Expected, 1e-6f);
+			if (TotalWeight > 0.0)
+			{
+				Test.TestEqual(*FString::Printf(TEXT("%s: probability of light %d"), Name, LightIndex), float(Probabilities[LightIndex]), Expected, 1e-5f);
+			}
+		}
+
+		// Stratified samples land on every light as often as its pdf and return the pdf of the light they land on
+		const int32 NumSamples = 1 << 16;
+		TArray<int32> Counts;
+		Counts.SetNumZeroed(NumLights);
+		for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+		{
+			float Pdf;
+			const int32 LightIndex = SampleCausticsLightAliasTable(Table, (SampleIndex + 0.5f) / NumSamples, Pdf);
+			if (!Test.TestTrue(*FString::Printf(TEXT("%s: sampled light %d"), Name, LightIndex), LightIndex >= 0 && LightIndex < NumLights))
+			{
+				return;
+			}
+			if (Pdf != Table[LightIndex].Pdf)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: sample %d returned the pdf %f of light %d, not %f"), Name, SampleIndex, Pdf, LightIndex, Table[LightIndex].Pdf));
+				return;
+			}
+			Counts[LightIndex]++;
+		}
+		if (TotalWeight > 0.0)
+		{
+			for (int32 LightIndex = 0; LightIndex < NumLights; ++LightIndex)
+			{
+				// Every entry is split at its threshold, which a stratified sample resolves to within a sample per entry
+				Test.TestEqual(*FString::Printf(TEXT("%s: frequency of light %d"), Name, LightIndex), float(Counts[LightIndex]) / NumSamples, Table[LightIndex].Pdf, 2.0f * NumLights / NumSamples);
+			}
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCausticsLightAliasTableTest, "CausticsReference.LightSampling.AliasTable", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FCausticsLightAliasTableTest::RunTest(const FString& Parameters)
+{
+	TestAliasTable(*this, TEXT("Single light"), { 2.0f });
+	TestAliasTable(*this, TEXT("Uniform"), { 1.0f, 1.0f, 1.0f, 1.0f });
+	TestAliasTable(*this, TEXT("Skewed"), { 1.0f, 2.0f, 3.0f, 4.0f, 0.0f, 10.0f, 0.001f });
+	TestAliasTable(*this, TEXT("Dominant"), { 1e6f, 1.0f, 1.0f });
+
+	// Irradiance weights span many orders of magnitude, the table also covers at most CausticsLightSamplingMaxLights lights
+	TArray<float> Weights;
+	uint32 Seed = 0x12345678u;
+	for (int32 LightIndex = 0; LightIndex < CausticsLightSamplingMaxLights + 16; ++LightIndex)
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		Weights.Add(FMath::Pow(10.0f, float(Seed >> 8) / float(1 << 24) * 6.0f - 3.0f));
+	}
+	TestAliasTable(*this, TEXT("Many lights"), Weights);
+
+	// Without any weight every light keeps a pdf of 0, and the light loop skips whatever it draws
+	TestAliasTable(*this, TEXT("No weight"), { 0.0f, 0.0f, 0.0f });
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
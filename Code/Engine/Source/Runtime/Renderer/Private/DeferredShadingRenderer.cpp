@@ -179,6 +179,15 @@ static TAutoConsoleVariable<int32> CVarRayTracingAsyncBuild(
 	ECVF_RenderThreadSafe
 );
 
+static TAutoConsoleVariable<int32> CVarRayTracingTranslucentScene(
+	TEXT("r.RayTracing.TranslucentScene"),
+	1,
+	TEXT("Whether to build a second ray tracing scene from the translucent instances only, for the caustics rays that only look for translucent geometry.\n")
+	TEXT(" 0: off, those rays traverse the full scene\n")
+	TEXT(" 1: on when ray traced translucency is rendered (default)"),
+	ECVF_RenderThreadSafe
+);
+
 #if !UE_BUILD_SHIPPING
 static TAutoConsoleVariable<int32> CVarForceBlackVelocityBuffer(
 	TEXT("r.Test.ForceBlackVelocityBuffer"), 0,
@@ -1064,6 +1073,40 @@ bool FDeferredShadingSceneRenderer::GatherRayTracingWorldInstances(FRHICommandLi
 		}
 	}
 
+	//
+
+	RayTracingTranslucentScenes.Reset();
+
+	bool bAnyViewWithTranslucentScene = false;
+	for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+	{
+		bAnyViewWithTranslucentScene |= ShouldRenderRayTracingTranslucency(Views[ViewIndex]);
+	}
+
+	if (CVarRayTracingTranslucentScene.GetValueOnRenderThread() != 0 && bAnyViewWithTranslucentScene)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(GatherRayTracingWorldInstances_TranslucentInstances);
+
+		RayTracingTranslucentScenes.SetNum(Views.Num());
+
+		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+		{
+			const FViewInfo& View = Views[ViewIndex];
+			FRayTracingTranslucentScene& TranslucentScene = RayTracingTranslucentScenes[ViewIndex];
+			TranslucentScene.InstanceRemap.Init(INDEX_NONE, View.RayTracingGeometryInstances.Num());
+
+			for (int32 InstanceIndex = 0; InstanceIndex < View.RayTracingGeometryInstances.Num(); InstanceIndex++)
+			{
+				// The whole instance is kept, so rays masked with RAY_TRACING_MASK_TRANSLUCENT see the same segments as in the full scene
+				const FRayTracingGeometryInstance& Instance = View.RayTracingGeometryInstances[InstanceIndex];
+				if (Instance.Mask & RAY_TRACING_MASK_TRANSLUCENT)
+				{
+					TranslucentScene.InstanceRemap[InstanceIndex] = TranslucentScene.Instances.Add(Instance);
+				}
+			}
+		}
+	}
+
 	return true;
 }
 
@@ -1122,6 +1165,15 @@ bool FDeferredShadingSceneRenderer::DispatchRayTracingWorldUpdates(FRHICommandLi
 
 		View.RayTracingScene.RayTracingSceneRHI = RHICreateRayTracingScene(SceneInitializer);
 
+		if (RayTracingTranslucentScenes.IsValidIndex(ViewIndex))
+		{
+			FRayTracingTranslucentScene& TranslucentScene = RayTracingTranslucentScenes[ViewIndex];
+
+			FRayTracingSceneInitializer TranslucentSceneInitializer = SceneInitializer;
+			TranslucentSceneInitializer.Instances = TranslucentScene.Instances;
+			TranslucentScene.RayTracingSceneRHI = RHICreateRayTracingScene(TranslucentSceneInitializer);
+		}
+
 		if (RayGenShaders.Num())
 		{
 			auto DefaultHitShader = View.ShaderMap->GetShader<FOpaqueShadowHitGroup>().GetRayTracingShader();
@@ -1167,6 +1219,11 @@ bool FDeferredShadingSceneRenderer::DispatchRayTracingWorldUpdates(FRHICommandLi
 			{
 				FViewInfo& View = Views[ViewIndex];
 				RHICmdList.BuildAccelerationStructure(View.RayTracingScene.RayTracingSceneRHI);
+
+				if (RayTracingTranslucentScenes.IsValidIndex(ViewIndex))
+				{
+					RHICmdList.BuildAccelerationStructure(RayTracingTranslucentScenes[ViewIndex].RayTracingSceneRHI);
+				}
 			}
 		}
 	}
@@ -1188,6 +1245,11 @@ bool FDeferredShadingSceneRenderer::DispatchRayTracingWorldUpdates(FRHICommandLi
 		{
 			FViewInfo& View = Views[ViewIndex];
 			RHIAsyncCmdList.BuildAccelerationStructure(View.RayTracingScene.RayTracingSceneRHI);
+
+			if (RayTracingTranslucentScenes.IsValidIndex(ViewIndex))
+			{
+				RHIAsyncCmdList.BuildAccelerationStructure(RayTracingTranslucentScenes[ViewIndex].RayTracingSceneRHI);
+			}
 		}
 
 		RHIAsyncCmdList.TransitionResource(EResourceTransitionAccess::ERWBarrier, EResourceTransitionPipeline::EComputeToGfx, nullptr, RayTracingDynamicGeometryUpdateEndFence);
@@ -1229,6 +1291,20 @@ void FDeferredShadingSceneRenderer::WaitForRayTracingScene(FRHICommandListImmedi
 					bCopyDataToInlineStorage);
 			}
 
+			// The translucent scene has its own shader binding table, indexed by its own instances.
+			// Its writer only points to the parameters of the writers above, which are deleted along with it.
+			if (RayTracingTranslucentScenes.IsValidIndex(ViewIndex))
+			{
+				FRayTracingLocalShaderBindingWriter* TranslucentBindingWriter = CreateRayTracingTranslucentSceneBindings(ViewIndex, View.RayTracingMaterialBindings);
+				const bool bCopyDataToInlineStorage = false;
+				TranslucentBindingWriter->Commit(
+					RHICmdList,
+					RayTracingTranslucentScenes[ViewIndex].RayTracingSceneRHI,
+					View.RayTracingMaterialPipeline,
+					bCopyDataToInlineStorage);
+				View.RayTracingMaterialBindings.Add(TranslucentBindingWriter);
+			}
+
 			// Move the ray tracing binding container ownership to the command list, so that memory will be
 			// released on the RHI thread timeline, after the commands that reference it are processed.
 			RHICmdList.EnqueueLambda([Ptrs = MoveTemp(View.RayTracingMaterialBindings)](FRHICommandListImmediate&)
@@ -1249,6 +1325,43 @@ void FDeferredShadingSceneRenderer::WaitForRayTracingScene(FRHICommandListImmedi
 	}
 }
 
+FRayTracingLocalShaderBindingWriter* FDeferredShadingSceneRenderer::CreateRayTracingTranslucentSceneBindings(int32 ViewIndex, const TArray<FRayTracingLocalShaderBindingWriter*>& MaterialBindings) const
+{
+	const TArray<int32>& InstanceRemap = RayTracingTranslucentScenes[ViewIndex].InstanceRemap;
+	FRayTracingLocalShaderBindingWriter* TranslucentBindingWriter = new FRayTracingLocalShaderBindingWriter();
+
+	for (const FRayTracingLocalShaderBindingWriter* BindingWriter : MaterialBindings)
+	{
+		for (const FRayTracingLocalShaderBindingWriter::FChunk* Chunk = BindingWriter->GetFirstChunk(); Chunk; Chunk = Chunk->Next)
+		{
+			for (uint32 BindingIndex = 0; BindingIndex < Chunk->Num; ++BindingIndex)
+			{
+				const FRayTracingLocalShaderBindings& Binding = Chunk->Bindings[BindingIndex];
+				if (!InstanceRemap.IsValidIndex(Binding.InstanceIndex) || InstanceRemap[Binding.InstanceIndex] == INDEX_NONE)
+				{
+					continue;
+				}
+
+				FRayTracingLocalShaderBindings& TranslucentBinding = TranslucentBindingWriter->AddWithExternalParameters();
+				TranslucentBinding = Binding;
+				TranslucentBinding.InstanceIndex = InstanceRemap[Binding.InstanceIndex];
+			}
+		}
+	}
+
+	return TranslucentBindingWriter;
+}
+
+FRHIShaderResourceView* FDeferredShadingSceneRenderer::GetRayTracingTranslucentSceneSRV(const FViewInfo& View) const
+{
+	const int32 ViewIndex = int32(&View - Views.GetData());
+	if (RayTracingTranslucentScenes.IsValidIndex(ViewIndex) && RayTracingTranslucentScenes[ViewIndex].RayTracingSceneRHI)
+	{
+		return RayTracingTranslucentScenes[ViewIndex].RayTracingSceneRHI->GetShaderResourceView();
+	}
+	return View.RayTracingScene.RayTracingSceneRHI->GetShaderResourceView();
+}
+
 
 #endif // RHI_RAYTRACING
 
@@ -2181,6 +2294,12 @@ void FDeferredShadingSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 	{
 		RenderRayTracingSkyLight(RHICmdList, SkyLightRT, SkyLightHitDistanceRT, HairDatas);
 	}
+
+	// The caustics only need the G-buffer and the ray tracing scene, they are traced before the lighting makes use of the scene color
+	if (bRayTracingEnabled && bCanOverlayRayTracingOutput && ViewFamily.EngineShowFlags.Translucency)
+	{
+		RenderRayTracingCausticsEarly(RHICmdList);
+	}
 #endif // RHI_RAYTRACING
 	checkSlow(RHICmdList.IsOutsideRenderPass());
 
@@ -2844,6 +2963,12 @@ void FDeferredShadingSceneRenderer::Render(FRHICommandListImmediate& RHICmdList)
 				View.RayTracingScene.RayTracingSceneRHI.SafeRelease();
 			}
 
+			if (RayTracingTranslucentScenes.IsValidIndex(ViewIndex) && RayTracingTranslucentScenes[ViewIndex].RayTracingSceneRHI)
+			{
+				RHICmdList.ClearRayTracingBindings(RayTracingTranslucentScenes[ViewIndex].RayTracingSceneRHI);
+				RayTracingTranslucentScenes[ViewIndex].RayTracingSceneRHI.SafeRelease();
+			}
+
 			// Release common lighting resources
 			View.RayTracingLightingDataSRV.SafeRelease();
 			View.RayTracingSubSurfaceProfileSRV.SafeRelease();
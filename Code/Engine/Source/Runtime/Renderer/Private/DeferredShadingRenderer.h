@@ -605,7 +605,8 @@ private:
 		int32 SamplePerPixel,
 		int32 HeightFog,
 		float ResolutionFraction,
-		ERayTracingPrimaryRaysFlag Flags);
+		ERayTracingPrimaryRaysFlag Flags,
+		FRDGTextureRef* OutFirstHitTexture = nullptr);
 
 	void RenderRayTracingTranslucency(FRHICommandListImmediate& RHICmdList);
 	void RenderRayTracingTranslucencyView(
@@ -617,17 +618,39 @@ private:
 		int32 HeightFog,
 		float ResolutionFraction);
 
+	/** Traces the caustics of every view ahead of the lighting, see r.RayTracing.Caustics.Early. */
+	void RenderRayTracingCausticsEarly(FRHICommandListImmediate& RHICmdList);
+
+	/**
+	 * Caustics of several views traced into the same outputs, see r.RayTracing.Translucency.BatchViews.
+	 * The first view creates what the others share, FinishRayTracingCausticsBatch() resolves and filters them once.
+	 */
+	struct FRayTracingCausticsBatch
+	{
+		TArray<const FViewInfo*> Views;
+		FRDGBufferRef ColorAccumulation = nullptr;
+		float ColorAccumulationScale = 1.0f;
+		int32 UpscaleFactor = 1;
+		FShaderResourceViewRHIRef EmitterTargetsSRV;
+		uint32 NumEmitterTargets = 0;
+	};
+
 	void RenderRayTracingCaustics(
 		FRDGBuilder& GraphBuilder,
 		const FViewInfo& View,
 		FRDGTextureRef* InOutColorTexture,
 		FRDGTextureRef* InOutRayHitDistanceTexture,
 		FRDGTextureRef* InOutRayImaginaryDepthTexture,
+		FRDGTextureRef FirstHitTexture,
 		int32 SamplePerPixel,
 		int32 HeightFog,
-		float ResolutionFraction
+		float ResolutionFraction,
+		FRayTracingCausticsBatch* Batch = nullptr
 	);
 
+	/** Resolves the caustics every view of the batch traced into *InOutColorTexture, then filters them. */
+	void FinishRayTracingCausticsBatch(FRDGBuilder& GraphBuilder, const FRayTracingCausticsBatch& Batch, FRDGTextureRef* InOutColorTexture);
+
 	/** Lighting Evaluation shader setup (used by ray traced reflections and translucency) */
 	void SetupRayTracingLightingMissShader(FRHICommandListImmediate& RHICmdList, const FViewInfo& View);
 
@@ -655,6 +678,12 @@ private:
 	FRayTracingPipelineState* BindRayTracingMaterialPipeline(FRHICommandList& RHICmdList, FViewInfo& View, const TArrayView<FRHIRayTracingShader*>& RayGenShaderTable, FRHIRayTracingShader* DefaultClosestHitShader);
 	FRayTracingPipelineState* BindRayTracingDeferredMaterialGatherPipeline(FRHICommandList& RHICmdList, const FViewInfo& View, FRHIRayTracingShader* RayGenShader);
 
+	/** Copies the material bindings of the translucent instances of a view to its translucent scene, with the instance indices of that scene. */
+	FRayTracingLocalShaderBindingWriter* CreateRayTracingTranslucentSceneBindings(int32 ViewIndex, const TArray<FRayTracingLocalShaderBindingWriter*>& MaterialBindings) const;
+
+	/** Translucent only scene of the view when it was built, the full ray tracing scene otherwise. */
+	FRHIShaderResourceView* GetRayTracingTranslucentSceneSRV(const FViewInfo& View) const;
+
 	// #dxr_todo: UE-72565: refactor ray tracing effects to not be member functions of DeferredShadingRenderer. Register each effect at startup and just loop over them automatically
 	static void PrepareRayTracingReflections(const FViewInfo& View, const FScene& Scene, TArray<FRHIRayTracingShader*>& OutRayGenShaders);
 	static void PrepareRayTracingDeferredReflections(const FViewInfo& View, const FScene& Scene, TArray<FRHIRayTracingShader*>& OutRayGenShaders);
@@ -675,6 +704,30 @@ private:
 	FComputeFenceRHIRef RayTracingDynamicGeometryUpdateBeginFence; // Signaled when ray tracing AS can start building
 	FComputeFenceRHIRef RayTracingDynamicGeometryUpdateEndFence; // Signaled when all AS for this frame are built
 
+	/**
+	 * Second ray tracing scene of a view that only holds its translucent instances, see r.RayTracing.TranslucentScene.
+	 * Rays that only look for translucent geometry traverse it instead of the full scene.
+	 */
+	struct FRayTracingTranslucentScene
+	{
+		TArray<FRayTracingGeometryInstance> Instances;
+
+		/** Index in the translucent scene of every instance of View.RayTracingGeometryInstances, INDEX_NONE when it is not translucent. */
+		TArray<int32> InstanceRemap;
+
+		FRayTracingSceneRHIRef RayTracingSceneRHI;
+	};
+	TArray<FRayTracingTranslucentScene> RayTracingTranslucentScenes; // One per view, empty when no translucent scene is built
+
+	/** Outputs of RenderRayTracingCausticsEarly(), picked up by RenderRayTracingTranslucency(). */
+	struct FRayTracingEarlyCaustics
+	{
+		TRefCountPtr<IPooledRenderTarget> Color;
+		TRefCountPtr<IPooledRenderTarget> RayHitDistance;
+		TRefCountPtr<IPooledRenderTarget> RayImaginaryDepth;
+	};
+	TArray<FRayTracingEarlyCaustics> RayTracingEarlyCaustics; // One per view, empty when the caustics are traced with the translucency
+
 #endif // RHI_RAYTRACING
 
 	/** Set to true if the lights needed for clustered shading have been injected in the light grid (set in ComputeLightGrid). */
@@ -6,15 +6,358 @@
 #if RHI_RAYTRACING
 
 #include "ClearQuad.h"
+#include "ScenePrivate.h"
 #include "SceneRendering.h"
 #include "SceneRenderTargets.h"
 #include "RHIResources.h"
+#include "RenderGraphUtils.h"
 #include "PostProcess/PostProcessing.h"
 #include "RayTracing/RaytracingOptions.h"
 #include "Raytracing/RaytracingLighting.h"
+#include "RayTracing/RayTracingTranslucencyHistory.h"
+
+static float GRayTracingCausticsAccumulationScale = 1024.0f;
+static FAutoConsoleVariableRef CVarRayTracingCausticsAccumulationScale(
+	TEXT("r.RayTracing.Caustics.AccumulationScale"),
+	GRayTracingCausticsAccumulationScale,
+	TEXT("Fixed point units per unit of radiance used to accumulate the caustics color with atomics. ")
+	TEXT("Larger values keep more precision for dim caustics, a single contribution is clamped to 8388608 units. (default = 1024)"),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingCausticsScreenPercentage = 100;
+static FAutoConsoleVariableRef CVarRayTracingCausticsScreenPercentage(
+	TEXT("r.RayTracing.Caustics.ScreenPercentage"),
+	GRayTracingCausticsScreenPercentage,
+	TEXT("Resolution of the screen space caustics, in percent of the view on each axis. The dispatch pixels jitter over the pixels they stand for ")
+	TEXT("from frame to frame and the composite upsamples the caustics guided by the depth and normal of the receivers.\n")
+	TEXT(" 100: full resolution (default)\n")
+	TEXT(" 50: a quarter of the pixels\n")
+	TEXT(" 25: a sixteenth of the pixels"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingCausticsMode(
+	TEXT("r.RayTracing.Caustics.Mode"),
+	0,
+	TEXT("Where the caustics light half paths start:\n")
+	TEXT(" 0: from every screen pixel towards every light (default)\n")
+	TEXT(" 1: from every light towards the bounds of the translucent instances, the ray count scales with the caustic casting geometry instead of the resolution"),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingCausticsLightSpaceResolution = 256;
+static FAutoConsoleVariableRef CVarRayTracingCausticsLightSpaceResolution(
+	TEXT("r.RayTracing.Caustics.LightSpace.Resolution"),
+	GRayTracingCausticsLightSpaceResolution,
+	TEXT("Rays per side of the grid emitted from each light towards each translucent instance when r.RayTracing.Caustics.Mode is 1. (default = 256)"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingCausticsLightCulling(
+	TEXT("r.RayTracing.Caustics.LightCulling"),
+	1,
+	TEXT("Whether the screen space caustics only trace towards the lights that can reach each cluster of the view through a translucent instance.\n")
+	TEXT(" 0: every light is traced from every pixel\n")
+	TEXT(" 1: lights are culled per cluster of 32x32 dispatch threads and 32 depth slices (default)"),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingCausticsLightSamplesPerPixel = 0;
+static FAutoConsoleVariableRef CVarRayTracingCausticsLightSamplesPerPixel(
+	TEXT("r.RayTracing.Caustics.LightSamplesPerPixel"),
+	GRayTracingCausticsLightSamplesPerPixel,
+	TEXT("Lights drawn per pixel by the screen space caustics, weighted by their estimated irradiance at the viewer, so that the cost does not grow with the light count.\n")
+	TEXT("0 visits every light (default)"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingCausticsTemporal(
+	TEXT("r.RayTracing.Caustics.Temporal"),
+	1,
+	TEXT("Whether the caustics are accumulated over frames, with a history reprojected with the receiver seen in each pixel.\n")
+	TEXT(" 0: every frame starts from scratch\n")
+	TEXT(" 1: the history is blended in up to r.RayTracing.Caustics.Temporal.MaxSamples frames per pixel (default)"),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingCausticsTemporalMaxSamples = 16;
+static FAutoConsoleVariableRef CVarRayTracingCausticsTemporalMaxSamples(
+	TEXT("r.RayTracing.Caustics.Temporal.MaxSamples"),
+	GRayTracingCausticsTemporalMaxSamples,
+	TEXT("Frames a pixel accumulates at most, the current frame is blended with a weight of one over this once reached. (default = 16)"),
+	ECVF_RenderThreadSafe);
+
+static float GRayTracingCausticsTemporalVarianceClampScale = 2.0f;
+static FAutoConsoleVariableRef CVarRayTracingCausticsTemporalVarianceClampScale(
+	TEXT("r.RayTracing.Caustics.Temporal.VarianceClampScale"),
+	GRayTracingCausticsTemporalVarianceClampScale,
+	TEXT("Standard deviations of the current frame around a pixel the history may stray from their mean before it is clamped. ")
+	TEXT("Lower values react faster to moving caustics and keep more noise. (default = 2)"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingCausticsWavefront(
+	TEXT("r.RayTracing.Caustics.Wavefront"),
+	0,
+	TEXT("How the screen space caustics are dispatched:\n")
+	TEXT(" 0: one ray generation shader traces the whole chain of every pixel (default)\n")
+	TEXT(" 1: the chain is split in occlusion, entry, exit and receiver stages, each dispatch only tracing the paths the previous one kept"),
+	ECVF_RenderThreadSafe);
+
+static float GRayTracingCausticsWavefrontQueueItemsPerPixel = 1.0f;
+static FAutoConsoleVariableRef CVarRayTracingCausticsWavefrontQueueItemsPerPixel(
+	TEXT("r.RayTracing.Caustics.Wavefront.QueueItemsPerPixel"),
+	GRayTracingCausticsWavefrontQueueItemsPerPixel,
+	TEXT("Capacity of the queues between the wavefront caustics stages, in paths per dispatch pixel. The receiver queue holds as many times the transmission samples. ")
+	TEXT("Paths past the capacity are dropped, every stage dispatches as many threads as its queue holds. (default = 1)"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingCausticsRenderTileSize(
+	TEXT("r.RayTracing.Caustics.RenderTileSize"),
+	0,
+	TEXT("Render the caustics in NxN tiles of their dispatch, where each tile is dispatched on its own, allowing high quality rendering without triggering timeout detection.\n")
+	TEXT("Ignored by the wavefront caustics. (default = 0, tiling disabled)"),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingCausticsProgressiveTilesPerFrame = 0;
+static FAutoConsoleVariableRef CVarRayTracingCausticsProgressiveTilesPerFrame(
+	TEXT("r.RayTracing.Caustics.ProgressiveTilesPerFrame"),
+	GRayTracingCausticsProgressiveTilesPerFrame,
+	TEXT("With r.RayTracing.Caustics.RenderTileSize, the screen space caustics only trace this many tiles per frame, in turn, and the other tiles keep\n")
+	TEXT("the caustics they had when they were last traced, and the temporal pass carries their history over without blending them again.\n")
+	TEXT("Light reaching a traced tile from an untraced one is missing from it until both are traced in the same frame. Every tile is traced again on camera cuts.\n")
+	TEXT("Needs r.RayTracing.Caustics.Temporal to keep the caustics of the view between frames. (default = 0, every tile every frame)"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingCausticsEarly(
+	TEXT("r.RayTracing.Caustics.Early"),
+	0,
+	TEXT("When the screen space caustics are traced.\n")
+	TEXT(" 0: with the ray traced translucency, after its refraction rays (default)\n")
+	TEXT(" 1: right after the ray tracing scene is ready and before the lighting, their result waits for the translucency composite.\n")
+	TEXT("    The caustics then have no first hits of the translucency to reuse, see r.RayTracing.Caustics.ReuseFirstHit"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingCausticsReuseFirstHit(
+	TEXT("r.RayTracing.Caustics.ReuseFirstHit"),
+	1,
+	TEXT("Whether the screen space caustics read the first hit of the camera ray of every pixel from the translucency instead of tracing it again.\n")
+	TEXT("Only at full resolution, with r.RayTracing.Caustics.ScreenPercentage and r.RayTracing.Translucency.Checkerboard off.\n")
+	TEXT("Without the first hits, below 100 caustics screen percentage, with the checkerboard, r.RayTracing.Caustics.Mode 1 or r.RayTracing.Caustics.Early,\n")
+	TEXT("every splat that passes the depth test traces a ray against the translucent instances to find out whether one hides it.\n")
+	TEXT(" 0: the caustics trace their own camera rays\n")
+	TEXT(" 1: the first hits of the translucency are reused (default)"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingCausticsAdaptiveSampling(
+	TEXT("r.RayTracing.Caustics.AdaptiveSampling"),
+	1,
+	TEXT("Whether the screen space caustics spread the transmission samples of rough dielectrics by the variance the temporal pass measured the frame before.\n")
+	TEXT(" 0: every pixel takes the sample count of the translucency (r.RayTracing.Translucency.SamplesPerPixel)\n")
+	TEXT(" 1: the noisy pixels take more samples and the converged ones fewer (default)\n")
+	TEXT("The total is not capped: the shares average to the sample count of the translucency before every pixel is clamped\n")
+	TEXT("between 1 and r.RayTracing.Caustics.AdaptiveSampling.MaxSamplesPerPixel, which can raise or lower it."),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingCausticsAdaptiveSamplingMaxSamplesPerPixel = 16;
+static FAutoConsoleVariableRef CVarRayTracingCausticsAdaptiveSamplingMaxSamplesPerPixel(
+	TEXT("r.RayTracing.Caustics.AdaptiveSampling.MaxSamplesPerPixel"),
+	GRayTracingCausticsAdaptiveSamplingMaxSamplesPerPixel,
+	TEXT("Transmission samples a single pixel takes at most with adaptive sampling, whatever its share of the samples. (default = 16)"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingCausticsDenoiser(
+	TEXT("r.RayTracing.Caustics.Denoiser"),
+	1,
+	TEXT("How the caustics are denoised before they are composited:\n")
+	TEXT(" 0: not at all\n")
+	TEXT(" 1: edge avoiding filter guided by the normal and depth of the receivers (default)\n")
+	TEXT(" 2: the reflections denoiser, with the hit distance and imaginary depth written by the caustics pass"),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingCausticsDenoiserIterations = 3;
+static FAutoConsoleVariableRef CVarRayTracingCausticsDenoiserIterations(
+	TEXT("r.RayTracing.Caustics.Denoiser.Iterations"),
+	GRayTracingCausticsDenoiserIterations,
+	TEXT("Iterations of the caustics filter, each one doubles the spacing of the taps of a 5x5 kernel. (default = 3)"),
+	ECVF_RenderThreadSafe);
+
+static float GRayTracingCausticsDenoiserLuminanceSigma = 0.5f;
+static FAutoConsoleVariableRef CVarRayTracingCausticsDenoiserLuminanceSigma(
+	TEXT("r.RayTracing.Caustics.Denoiser.LuminanceSigma"),
+	GRayTracingCausticsDenoiserLuminanceSigma,
+	TEXT("Relative luminance difference over which the caustics filter stops mixing two texels, lower values keep sharper caustic edges and more noise. (default = 0.5)"),
+	ECVF_RenderThreadSafe);
+
+// Mirror DefaultCausticsDenoiserNormalPower and DefaultCausticsDenoiserDepthSigma in CausticsDenoiser.h
+static const float CausticsDenoiserNormalPower = 64.0f;
+static const float CausticsDenoiserDepthSigma = 0.02f;
+
+// Relative difference between the reprojected depth of a receiver and the depth in the history beyond which the history is dropped
+static const float CausticsTemporalDepthRejectionThreshold = 0.05f;
+
+// Mirror CAUSTICS_LIGHT_CULLING_* in RayTracingCausticsLightCulling.ush
+static const int32 CausticsLightCullingTileSize = 32;
+static const int32 CausticsLightCullingNumSlices = 32;
+static const int32 CausticsLightCullingMaskWords = 8;
+
+// Mirror CAUSTICS_LIGHT_SAMPLING_* and FCausticsLightAliasEntry in RayTracingCausticsLightSampling.ush
+static const int32 CausticsLightSamplingMaxLights = 256;
+static const float CausticsLightSamplingMinDistance = 100.0f;
+
+struct FCausticsLightAliasEntry
+{
+	float Threshold;
+	uint32 Alias;
+	float Pdf;
+	uint32 Padding;
+};
+
+// Mirror the queue items and CAUSTICS_WAVEFRONT_* in RayTracingCausticsWavefront.ush
+static const int32 CausticsEntryQueueItemSize = 13 * sizeof(uint32);
+static const int32 CausticsExitQueueItemSize = 21 * sizeof(uint32);
+static const int32 CausticsReceiverQueueItemSize = 10 * sizeof(uint32);
+static const int32 CausticsWavefrontNumStages = 4;
+static const int32 CausticsWavefrontNumQueues = 3;
 
 DECLARE_GPU_STAT(RayTracingCaustics);
 
+static bool UseRayTracingCausticsLightSpaceEmission()
+{
+	return CVarRayTracingCausticsMode.GetValueOnRenderThread() == 1;
+}
+
+static int32 GetRayTracingCausticsLightSamplesPerPixel()
+{
+	return UseRayTracingCausticsLightSpaceEmission() ? 0 : FMath::Max(GRayTracingCausticsLightSamplesPerPixel, 0);
+}
+
+static bool UseRayTracingCausticsWavefront()
+{
+	return !UseRayTracingCausticsLightSpaceEmission() && CVarRayTracingCausticsWavefront.GetValueOnRenderThread() != 0;
+}
+
+static bool UseRayTracingCausticsLightCulling()
+{
+	return !UseRayTracingCausticsLightSpaceEmission() && CVarRayTracingCausticsLightCulling.GetValueOnRenderThread() != 0;
+}
+
+// Bounding spheres of the primitives behind every translucent ray tracing instance, the targets of light space emission
+static void GatherCausticsEmitterTargets(const FScene& Scene, const FViewInfo& View, TResourceArray<FVector4>& OutTargets)
+{
+	TBitArray<> VisitedPrimitives(false, Scene.PrimitiveBounds.Num());
+	for (const FRayTracingGeometryInstance& Instance : View.RayTracingGeometryInstances)
+	{
+		if ((Instance.Mask & RAY_TRACING_MASK_TRANSLUCENT) == 0 || Instance.UserData.Num() == 0)
+		{
+			continue;
+		}
+
+		const int32 PrimitiveIndex = int32(Instance.UserData[0]);
+		if (!Scene.PrimitiveBounds.IsValidIndex(PrimitiveIndex) || VisitedPrimitives[PrimitiveIndex])
+		{
+			continue;
+		}
+		VisitedPrimitives[PrimitiveIndex] = true;
+
+		const FBoxSphereBounds& Bounds = Scene.PrimitiveBounds[PrimitiveIndex].BoxSphereBounds;
+		OutTargets.Add(FVector4(Bounds.Origin, Bounds.SphereRadius));
+	}
+}
+
+// Selection weights of the lights in the order of View.RayTracingLightingDataSRV, which CreateLightDataPackedUniformBuffer
+// fills with the lights of the scene that have no valid static lighting and affect reflections.
+// Mirrors GetCausticsLightSelectionWeight() in RayTracingCausticsLightSampling.ush.
+static void GatherCausticsLightSelectionWeights(const FScene& Scene, const FViewInfo& View, TArray<float>& OutWeights)
+{
+	for (const FLightSceneInfoCompact& Light : Scene.Lights)
+	{
+		if (OutWeights.Num() >= CausticsLightSamplingMaxLights)
+		{
+			break;
+		}
+
+		const FLightSceneProxy* Proxy = Light.LightSceneInfo->Proxy;
+		if ((Proxy->HasStaticLighting() && Light.LightSceneInfo->IsPrecomputedLightingValid()) || !Proxy->AffectReflection())
+		{
+			continue;
+		}
+
+		FLightShaderParameters LightParameters;
+		Proxy->GetLightShaderParameters(LightParameters);
+
+		// Luminance() from Common.ush
+		const float Power = LightParameters.Color | FVector(0.3f, 0.59f, 0.11f);
+		if (Light.LightType == LightType_Directional)
+		{
+			OutWeights.Add(Power);
+		}
+		else if (Light.LightType > LightType_Rect)
+		{
+			OutWeights.Add(0.0f);
+		}
+		else
+		{
+			OutWeights.Add(Power / FMath::Max(FVector::DistSquared(View.ViewMatrices.GetViewOrigin(), LightParameters.Position), FMath::Square(CausticsLightSamplingMinDistance)));
+		}
+	}
+}
+
+// Alias table of the caustics light selection with Vose's method, one entry per weight.
+// Every entry keeps a Pdf of 0 when the weights sum to 0, and the light loop skips whatever it draws.
+static void BuildCausticsLightAliasTable(const TArray<float>& Weights, TResourceArray<FCausticsLightAliasEntry>& OutTable)
+{
+	const int32 NumLights = Weights.Num();
+
+	double TotalWeight = 0.0;
+	for (float Weight : Weights)
+	{
+		TotalWeight += Weight;
+	}
+
+	// Scaled weights average to 1, each entry takes the probability missing under 1 from a light above 1
+	TArray<float> ScaledWeights;
+	TArray<int32> Small;
+	TArray<int32> Large;
+	ScaledWeights.SetNumUninitialized(NumLights);
+	OutTable.SetNumUninitialized(NumLights);
+	for (int32 LightIndex = 0; LightIndex < NumLights; ++LightIndex)
+	{
+		FCausticsLightAliasEntry& Entry = OutTable[LightIndex];
+		Entry.Threshold = 1.0f;
+		Entry.Alias = LightIndex;
+		Entry.Pdf = TotalWeight > 0.0 ? float(Weights[LightIndex] / TotalWeight) : 0.0f;
+		Entry.Padding = 0;
+
+		ScaledWeights[LightIndex] = Entry.Pdf * NumLights;
+		if (ScaledWeights[LightIndex] < 1.0f)
+		{
+			Small.Add(LightIndex);
+		}
+		else
+		{
+			Large.Add(LightIndex);
+		}
+	}
+
+	if (TotalWeight <= 0.0)
+	{
+		return;
+	}
+
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		const int32 SmallIndex = Small.Pop(false);
+		const int32 LargeIndex = Large.Pop(false);
+		OutTable[SmallIndex].Threshold = ScaledWeights[SmallIndex];
+		OutTable[SmallIndex].Alias = LargeIndex;
+
+		ScaledWeights[LargeIndex] = (ScaledWeights[LargeIndex] + ScaledWeights[SmallIndex]) - 1.0f;
+		if (ScaledWeights[LargeIndex] < 1.0f)
+		{
+			Small.Add(LargeIndex);
+		}
+		else
+		{
+			Large.Add(LargeIndex);
+		}
+	}
+	// Whatever is left is 1 up to rounding and keeps its own light
+}
+
 class FRayTracingCausticsRGS : public FGlobalShader
 {
 	DECLARE_GLOBAL_SHADER(FRayTracingCausticsRGS)
@@ -22,7 +365,11 @@ class FRayTracingCausticsRGS : public FGlobalShader
 
 		class FDenoiserOutput : SHADER_PERMUTATION_BOOL("DIM_DENOISER_OUTPUT");
 	class FEnableTwoSidedGeometryForShadowDim : SHADER_PERMUTATION_BOOL("ENABLE_TWO_SIDED_GEOMETRY");
-	using FPermutationDomain = TShaderPermutationDomain<FDenoiserOutput, FEnableTwoSidedGeometryForShadowDim>;
+	class FLightSpaceEmissionDim : SHADER_PERMUTATION_BOOL("DIM_LIGHT_SPACE_EMISSION");
+
+	// 0 is the megakernel, the others the CAUSTICS_WAVEFRONT_STAGE_* of the screen space caustics
+	class FWavefrontStageDim : SHADER_PERMUTATION_INT("DIM_WAVEFRONT_STAGE", CausticsWavefrontNumStages + 1);
+	using FPermutationDomain = TShaderPermutationDomain<FDenoiserOutput, FEnableTwoSidedGeometryForShadowDim, FLightSpaceEmissionDim, FWavefrontStageDim>;
 
 	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
 		SHADER_PARAMETER(int32, SamplesPerPixel)
@@ -41,7 +388,27 @@ class FRayTracingCausticsRGS : public FGlobalShader
 		SHADER_PARAMETER(float, MaxNormalBias)
 
 		SHADER_PARAMETER_SRV(RaytracingAccelerationStructure, TLAS)
+		SHADER_PARAMETER_SRV(RaytracingAccelerationStructure, TranslucentTLAS)
 		SHADER_PARAMETER_SRV(StructuredBuffer<FRTLightingData>, LightDataBuffer)
+		SHADER_PARAMETER_SRV(StructuredBuffer<float4>, CausticsEmitterTargets)
+		SHADER_PARAMETER(uint32, NumCausticsEmitterTargets)
+		SHADER_PARAMETER(uint32, LightSpaceResolution)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, CausticsLightMasks)
+		SHADER_PARAMETER(uint32, CausticsLightCulling)
+		SHADER_PARAMETER(FIntPoint, CausticsLightCullingTileCount)
+		SHADER_PARAMETER_SRV(StructuredBuffer<FCausticsLightAliasEntry>, CausticsLightAliasTable)
+		SHADER_PARAMETER(uint32, CausticsLightSamplesPerPixel)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, CausticsVariance)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, CausticsVarianceSum)
+		SHADER_PARAMETER(uint32, CausticsAdaptiveSampling)
+		SHADER_PARAMETER(uint32, CausticsMaxSamplesPerPixel)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FCausticsEntryQueueItem>, CausticsEntryQueue)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FCausticsExitQueueItem>, CausticsExitQueue)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FCausticsReceiverQueueItem>, CausticsReceiverQueue)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, CausticsQueueCounters)
+		SHADER_PARAMETER(uint32, CausticsEntryQueueCapacity)
+		SHADER_PARAMETER(uint32, CausticsExitQueueCapacity)
+		SHADER_PARAMETER(uint32, CausticsReceiverQueueCapacity)
 		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SSProfilesTexture)
 
 		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, ViewUniformBuffer)
@@ -54,26 +421,538 @@ class FRayTracingCausticsRGS : public FGlobalShader
 
 		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SceneColorTexture)
 
-		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, ColorOutput)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, ColorAccumulationOutput)
+		SHADER_PARAMETER(FIntPoint, ColorAccumulationExtent)
+		SHADER_PARAMETER(float, ColorAccumulationScale)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, RayHitDistanceOutput)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, RayImaginaryDepthOutput)
+		SHADER_PARAMETER(uint32, RenderTileOffsetX)
+		SHADER_PARAMETER(uint32, RenderTileOffsetY)
+		SHADER_PARAMETER(uint32, AccumulationFrameIndex)
+
+		// First hits of the camera rays of the translucency
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<uint2>, FirstHitTexture)
+		SHADER_PARAMETER(uint32, ReuseFirstHit)
 		END_SHADER_PARAMETER_STRUCT()
 
 		static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
 	{
+		// The wavefront stages only exist for the screen space caustics
+		FPermutationDomain PermutationVector(Parameters.PermutationId);
+		if (PermutationVector.Get<FWavefrontStageDim>() != 0 && PermutationVector.Get<FLightSpaceEmissionDim>())
+		{
+			return false;
+		}
 		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
 	}
 };
 
 IMPLEMENT_GLOBAL_SHADER(FRayTracingCausticsRGS, "/Engine/Private/RayTracing/RayTracingCaustics.usf", "RayTracingCausticsRGS", SF_RayGen);
 
+class FRayTracingCausticsLightCullingCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FRayTracingCausticsLightCullingCS)
+	SHADER_USE_PARAMETER_STRUCT(FRayTracingCausticsLightCullingCS, FGlobalShader)
+
+	static const uint32 ThreadGroupSize = 8;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(int32, UpscaleFactor)
+		SHADER_PARAMETER(FIntPoint, CausticsLightCullingTileCount)
+		SHADER_PARAMETER_SRV(StructuredBuffer<FRTLightingData>, LightDataBuffer)
+		SHADER_PARAMETER_SRV(StructuredBuffer<float4>, CausticsEmitterTargets)
+		SHADER_PARAMETER(uint32, NumCausticsEmitterTargets)
+		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, ViewUniformBuffer)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, CausticsLightMasksOutput)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+		// The light data layout comes from the ray tracing headers, which only DXC compiles
+		OutEnvironment.CompilerFlags.Add(CFLAG_ForceDXC);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FRayTracingCausticsLightCullingCS, "/Engine/Private/RayTracing/RayTracingCausticsLightCulling.usf", "RayTracingCausticsLightCullingCS", SF_Compute);
+
+class FRayTracingCausticsResolveCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FRayTracingCausticsResolveCS)
+	SHADER_USE_PARAMETER_STRUCT(FRayTracingCausticsResolveCS, FGlobalShader)
+
+	static const uint32 ThreadGroupSize = 8;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ColorAccumulation)
+		SHADER_PARAMETER(FIntPoint, ColorAccumulationExtent)
+		SHADER_PARAMETER(float, ColorAccumulationScale)
+		SHADER_PARAMETER(FIntPoint, ProgressiveTileOrigin)
+		SHADER_PARAMETER(uint32, ProgressiveTileSize)
+		SHADER_PARAMETER(uint32, ProgressiveNumTilesX)
+		SHADER_PARAMETER(uint32, ProgressiveNumTiles)
+		SHADER_PARAMETER(uint32, ProgressiveFirstTile)
+		SHADER_PARAMETER(uint32, ProgressiveNumTracedTiles)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, ColorOutput)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FRayTracingCausticsResolveCS, "/Engine/Private/RayTracing/RayTracingCausticsResolve.usf", "RayTracingCausticsResolveCS", SF_Compute);
+
+class FRayTracingCausticsTemporalCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FRayTracingCausticsTemporalCS)
+	SHADER_USE_PARAMETER_STRUCT(FRayTracingCausticsTemporalCS, FGlobalShader)
+
+	static const uint32 ThreadGroupSize = 8;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, CausticsColor)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, CausticsHistoryColor)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float2>, CausticsHistoryMetadata)
+		SHADER_PARAMETER_SAMPLER(SamplerState, CausticsHistorySampler)
+		SHADER_PARAMETER(FIntPoint, CausticsExtent)
+		SHADER_PARAMETER(FIntPoint, CausticsRectMin)
+		SHADER_PARAMETER(FIntPoint, CausticsRectMax)
+		SHADER_PARAMETER(uint32, CausticsHistoryValid)
+		SHADER_PARAMETER(uint32, UpscaleFactor)
+		SHADER_PARAMETER(float, MaxSamples)
+		SHADER_PARAMETER(float, VarianceClampScale)
+		SHADER_PARAMETER(float, DepthRejectionThreshold)
+		SHADER_PARAMETER(FIntPoint, ProgressiveTileOrigin)
+		SHADER_PARAMETER(uint32, ProgressiveTileSize)
+		SHADER_PARAMETER(uint32, ProgressiveNumTilesX)
+		SHADER_PARAMETER(uint32, ProgressiveNumTiles)
+		SHADER_PARAMETER(uint32, ProgressiveFirstTile)
+		SHADER_PARAMETER(uint32, ProgressiveNumTracedTiles)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FSceneTextureParameters, SceneTextures)
+		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, ViewUniformBuffer)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, ColorOutput)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float2>, MetadataOutput)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, VarianceOutput)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FRayTracingCausticsTemporalCS, "/Engine/Private/RayTracing/RayTracingCausticsTemporal.usf", "RayTracingCausticsTemporalCS", SF_Compute);
+
+class FRayTracingCausticsVarianceSumCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FRayTracingCausticsVarianceSumCS)
+	SHADER_USE_PARAMETER_STRUCT(FRayTracingCausticsVarianceSumCS, FGlobalShader)
+
+	static const uint32 ThreadGroupSize = 8;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, CausticsVariance)
+		SHADER_PARAMETER(FIntPoint, CausticsExtent)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, CausticsVarianceSumOutput)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FRayTracingCausticsVarianceSumCS, "/Engine/Private/RayTracing/RayTracingCausticsAdaptiveSampling.usf", "RayTracingCausticsVarianceSumCS", SF_Compute);
+
+class FRayTracingCausticsDenoiserCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FRayTracingCausticsDenoiserCS)
+	SHADER_USE_PARAMETER_STRUCT(FRayTracingCausticsDenoiserCS, FGlobalShader)
+
+	static const uint32 ThreadGroupSize = 8;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, CausticsColor)
+		SHADER_PARAMETER(FIntPoint, CausticsExtent)
+		SHADER_PARAMETER(uint32, UpscaleFactor)
+		SHADER_PARAMETER(float, StepSize)
+		SHADER_PARAMETER(float, NormalPower)
+		SHADER_PARAMETER(float, DepthSigma)
+		SHADER_PARAMETER(float, LuminanceSigma)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FSceneTextureParameters, SceneTextures)
+		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, ViewUniformBuffer)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, ColorOutput)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FRayTracingCausticsDenoiserCS, "/Engine/Private/RayTracing/RayTracingCausticsDenoiser.usf", "RayTracingCausticsDenoiserCS", SF_Compute);
+
+// Fraction of the screen the caustics are traced at, one over the upscale factor r.RayTracing.Caustics.ScreenPercentage
+// rounds to. The dispatch pixels must divide the screen evenly, so the factor is a power of two between 1 and 4.
+float GetRayTracingCausticsResolutionFraction()
+{
+	const int32 UpscaleFactor = FMath::Clamp(int32(FMath::RoundUpToPowerOfTwo(FMath::DivideAndRoundNearest(100, FMath::Clamp(GRayTracingCausticsScreenPercentage, 25, 100)))), 1, 4);
+	return 1.0f / UpscaleFactor;
+}
+
+bool UseRayTracingCausticsEarly()
+{
+	return CVarRayTracingCausticsEarly.GetValueOnRenderThread() != 0;
+}
+
+// Whether RenderRayTracingTranslucency asks the translucency for the first hits of its camera rays, light space emission has no camera rays
+bool UseRayTracingCausticsFirstHit()
+{
+	return CVarRayTracingCausticsReuseFirstHit.GetValueOnRenderThread() != 0
+		&& !UseRayTracingCausticsEarly()
+		&& !UseRayTracingCausticsLightSpaceEmission()
+		&& GetRayTracingCausticsResolutionFraction() == 1.0f;
+}
+
+// Whether RenderRayTracingTranslucency still hands the caustics to IScreenSpaceDenoiser::DenoiseReflections
+bool UseRayTracingCausticsReflectionDenoiser()
+{
+	return CVarRayTracingCausticsDenoiser.GetValueOnRenderThread() == 2;
+}
+
+// Edge avoiding a-trous iterations over the caustics, replaces *InOutColorTexture with the result
+static void AddCausticsDenoiserPasses(
+	FRDGBuilder& GraphBuilder,
+	const FViewInfo& View,
+	const FSceneTextureParameters& SceneTextures,
+	int32 UpscaleFactor,
+	FRDGTextureRef* InOutColorTexture)
+{
+	const FPooledRenderTargetDesc& ColorDesc = (*InOutColorTexture)->Desc;
+	TShaderMapRef<FRayTracingCausticsDenoiserCS> DenoiserShader(View.ShaderMap);
+
+	const int32 NumIterations = FMath::Clamp(GRayTracingCausticsDenoiserIterations, 0, 8);
+	for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+	{
+		const int32 StepSize = 1 << Iteration;
+		FRDGTextureRef ColorOutput = GraphBuilder.CreateTexture(ColorDesc, TEXT("RayTracingCausticsDenoised"));
+
+		FRayTracingCausticsDenoiserCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FRayTracingCausticsDenoiserCS::FParameters>();
+		PassParameters->CausticsColor = *InOutColorTexture;
+		PassParameters->CausticsExtent = ColorDesc.Extent;
+		PassParameters->UpscaleFactor = UpscaleFactor;
+		PassParameters->StepSize = StepSize;
+		PassParameters->NormalPower = CausticsDenoiserNormalPower;
+		PassParameters->DepthSigma = CausticsDenoiserDepthSigma;
+		PassParameters->LuminanceSigma = FMath::Max(GRayTracingCausticsDenoiserLuminanceSigma, 1e-4f);
+		PassParameters->SceneTextures = SceneTextures;
+		PassParameters->ViewUniformBuffer = View.ViewUniformBuffer;
+		PassParameters->ColorOutput = GraphBuilder.CreateUAV(ColorOutput);
+
+		FComputeShaderUtils::AddPass(
+			GraphBuilder,
+			RDG_EVENT_NAME("RayTracingCausticsDenoiser(Step=%d) %dx%d", StepSize, ColorDesc.Extent.X, ColorDesc.Extent.Y),
+			DenoiserShader,
+			PassParameters,
+			FComputeShaderUtils::GetGroupCount(ColorDesc.Extent, FRayTracingCausticsDenoiserCS::ThreadGroupSize));
+
+		*InOutColorTexture = ColorOutput;
+	}
+}
+
+// Render tiles traced this frame by the progressive caustics, see r.RayTracing.Caustics.ProgressiveTilesPerFrame
+struct FCausticsProgressiveTiles
+{
+	FIntPoint Origin = FIntPoint::ZeroValue;
+	int32 TileSize = 0;
+	int32 NumTilesX = 0;
+	int32 NumTiles = 0;
+	int32 FirstTile = 0;
+
+	// 0 when every tile is traced
+	int32 NumTracedTiles = 0;
+};
+
+template<typename TPassParameters>
+static void SetCausticsProgressiveTileParameters(TPassParameters* PassParameters, const FCausticsProgressiveTiles& ProgressiveTiles)
+{
+	PassParameters->ProgressiveTileOrigin = ProgressiveTiles.Origin;
+	PassParameters->ProgressiveTileSize = ProgressiveTiles.TileSize;
+	PassParameters->ProgressiveNumTilesX = ProgressiveTiles.NumTilesX;
+	PassParameters->ProgressiveNumTiles = ProgressiveTiles.NumTiles;
+	PassParameters->ProgressiveFirstTile = ProgressiveTiles.FirstTile;
+	PassParameters->ProgressiveNumTracedTiles = ProgressiveTiles.NumTracedTiles;
+}
+
+// Outputs of the temporal pass, shared by the views traced into the same caustics
+struct FCausticsTemporalOutputs
+{
+	FRDGTextureRef Color = nullptr;
+	FRDGTextureRef Metadata = nullptr;
+	FRDGTextureRef Variance = nullptr;
+};
+
+// Blends the resolved caustics of this frame in Rect with the history of the view, into the outputs it creates when they are null
+static void AddCausticsTemporalPass(
+	FRDGBuilder& GraphBuilder,
+	const FViewInfo& View,
+	const FSceneTextureParameters& SceneTextures,
+	int32 UpscaleFactor,
+	FRDGTextureRef ColorTexture,
+	FIntRect Rect,
+	const FCausticsProgressiveTiles& ProgressiveTiles,
+	FCausticsTemporalOutputs& Outputs)
+{
+	// Views without a state, like most scene captures, have nowhere to keep a history
+	if (!View.ViewState)
+	{
+		return;
+	}
+
+	const FRayTracingCausticsHistory& History = View.PrevViewInfo.RayTracingCausticsHistory;
+	const FPooledRenderTargetDesc& ColorDesc = ColorTexture->Desc;
+	const bool bHistoryValid = History.Color.IsValid()
+		&& History.Color->GetDesc().Extent == ColorDesc.Extent
+		&& !View.bCameraCut
+		&& !View.bPrevTransformsReset;
+
+	if (!Outputs.Color)
+	{
+		FPooledRenderTargetDesc MetadataDesc = ColorDesc;
+		MetadataDesc.Format = PF_G32R32F;
+		FPooledRenderTargetDesc VarianceDesc = ColorDesc;
+		VarianceDesc.Format = PF_R16F;
+
+		Outputs.Color = GraphBuilder.CreateTexture(ColorDesc, TEXT("RayTracingCausticsTemporalColor"));
+		Outputs.Metadata = GraphBuilder.CreateTexture(MetadataDesc, TEXT("RayTracingCausticsTemporalMetadata"));
+		Outputs.Variance = GraphBuilder.CreateTexture(VarianceDesc, TEXT("RayTracingCausticsTemporalVariance"));
+
+		// The views only write their own rect, whatever lies between them is read by the filter
+		if (Rect.Min != FIntPoint::ZeroValue || Rect.Max != ColorDesc.Extent)
+		{
+			AddClearUAVPass(GraphBuilder, GraphBuilder.CreateUAV(Outputs.Color), FLinearColor::Transparent);
+			AddClearUAVPass(GraphBuilder, GraphBuilder.CreateUAV(Outputs.Metadata), FLinearColor::Transparent);
+			AddClearUAVPass(GraphBuilder, GraphBuilder.CreateUAV(Outputs.Variance), FLinearColor::Transparent);
+		}
+	}
+
+	FRayTracingCausticsTemporalCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FRayTracingCausticsTemporalCS::FParameters>();
+	PassParameters->CausticsColor = ColorTexture;
+	PassParameters->CausticsHistoryColor = GraphBuilder.RegisterExternalTexture(bHistoryValid ? History.Color : GSystemTextures.BlackDummy);
+	PassParameters->CausticsHistoryMetadata = GraphBuilder.RegisterExternalTexture(bHistoryValid ? History.Metadata : GSystemTextures.BlackDummy);
+	PassParameters->CausticsHistorySampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+	PassParameters->CausticsExtent = ColorDesc.Extent;
+	PassParameters->CausticsRectMin = Rect.Min;
+	PassParameters->CausticsRectMax = Rect.Max;
+	PassParameters->CausticsHistoryValid = bHistoryValid ? 1 : 0;
+	PassParameters->UpscaleFactor = UpscaleFactor;
+	PassParameters->MaxSamples = FMath::Max(GRayTracingCausticsTemporalMaxSamples, 1);
+	PassParameters->VarianceClampScale = FMath::Max(GRayTracingCausticsTemporalVarianceClampScale, 0.0f);
+	PassParameters->DepthRejectionThreshold = CausticsTemporalDepthRejectionThreshold;
+	SetCausticsProgressiveTileParameters(PassParameters, ProgressiveTiles);
+	PassParameters->SceneTextures = SceneTextures;
+	PassParameters->ViewUniformBuffer = View.ViewUniformBuffer;
+	PassParameters->ColorOutput = GraphBuilder.CreateUAV(Outputs.Color);
+	PassParameters->MetadataOutput = GraphBuilder.CreateUAV(Outputs.Metadata);
+	PassParameters->VarianceOutput = GraphBuilder.CreateUAV(Outputs.Variance);
+
+	TShaderMapRef<FRayTracingCausticsTemporalCS> TemporalShader(View.ShaderMap);
+	FComputeShaderUtils::AddPass(
+		GraphBuilder,
+		RDG_EVENT_NAME("RayTracingCausticsTemporal %dx%d", Rect.Width(), Rect.Height()),
+		TemporalShader,
+		PassParameters,
+		FComputeShaderUtils::GetGroupCount(Rect.Size(), FRayTracingCausticsTemporalCS::ThreadGroupSize));
+
+	// A view rendered several times in a frame only keeps the history of its first render.
+	// Views sharing the outputs each keep them whole, and only read back their own rect.
+	if (!View.bStatePrevViewInfoIsReadOnly)
+	{
+		FRayTracingCausticsHistory& NewHistory = View.ViewState->PrevFrameViewInfo.RayTracingCausticsHistory;
+		GraphBuilder.QueueTextureExtraction(Outputs.Color, &NewHistory.Color);
+		GraphBuilder.QueueTextureExtraction(Outputs.Metadata, &NewHistory.Metadata);
+		GraphBuilder.QueueTextureExtraction(Outputs.Variance, &NewHistory.Variance);
+	}
+}
+
+// Variance the temporal pass left for this view the frame before, or null when it does not match the caustics of this frame
+static const TRefCountPtr<IPooledRenderTarget>* FindCausticsHistoryVariance(const FViewInfo& View, FIntPoint Extent)
+{
+	const TRefCountPtr<IPooledRenderTarget>& Variance = View.PrevViewInfo.RayTracingCausticsHistory.Variance;
+	if (!View.ViewState || !Variance.IsValid() || Variance->GetDesc().Extent != Extent || View.bCameraCut)
+	{
+		return nullptr;
+	}
+	return &Variance;
+}
+
+// Texture the history of the view keeps from frame to frame while the caustics are accumulated over frames, so that the
+// buffers next to the caustics keep their memory instead of going back to the pool, and are still there for the temporal passes to read.
+// Without a history the texture is transient and may alias the memory of other transient targets.
+// bOutPersisted tells whether the texture still holds what the view wrote in it the frame before.
+FRDGTextureRef CreateRayTracingCausticsPersistentTexture(FRDGBuilder& GraphBuilder, const FViewInfo& View, FPooledRenderTargetDesc Desc, ERayTracingCausticsPersistentTexture::Type Slot, const TCHAR* Name, bool* bOutPersisted = nullptr)
+{
+	if (bOutPersisted)
+	{
+		*bOutPersisted = false;
+	}
+
+	if (CVarRayTracingCausticsTemporal.GetValueOnRenderThread() == 0 || !View.ViewState || View.bStatePrevViewInfoIsReadOnly)
+	{
+		Desc.Flags |= TexCreate_Transient;
+		return GraphBuilder.CreateTexture(Desc, Name);
+	}
+
+	const TRefCountPtr<IPooledRenderTarget>& PrevTexture = View.PrevViewInfo.RayTracingCausticsHistory.PersistentTextures[Slot];
+	TRefCountPtr<IPooledRenderTarget>& NewTexture = View.ViewState->PrevFrameViewInfo.RayTracingCausticsHistory.PersistentTextures[Slot];
+	if (PrevTexture.IsValid() && PrevTexture->GetDesc().Compare(Desc, false))
+	{
+		if (bOutPersisted)
+		{
+			*bOutPersisted = true;
+		}
+		NewTexture = PrevTexture;
+		return GraphBuilder.RegisterExternalTexture(PrevTexture, Name);
+	}
+
+	FRDGTextureRef Texture = GraphBuilder.CreateTexture(Desc, Name);
+	GraphBuilder.QueueTextureExtraction(Texture, &NewTexture);
+	return Texture;
+}
+
+extern bool IsRayTracingTranslucencyAccumulating(const FViewInfo& View);
+extern uint32 GetRayTracingTranslucencyAccumulationFrameIndex(const FViewInfo& View);
+extern void AddRayTracingTranslucencyAccumulationPass(FRDGBuilder& GraphBuilder, const FViewInfo& View, FIntRect Rect, const TCHAR* Name, FRDGTextureRef* InOutTexture);
+
+// Resolves the color accumulation of the views traced into *InOutColorTexture, then filters it and replaces *InOutColorTexture with the result
+static void AddCausticsResolvePasses(
+	FRDGBuilder& GraphBuilder,
+	TArrayView<const FViewInfo* const> Views,
+	const FSceneTextureParameters& SceneTextures,
+	int32 UpscaleFactor,
+	FRDGBufferRef ColorAccumulationBuffer,
+	float ColorAccumulationScale,
+	const FCausticsProgressiveTiles& ProgressiveTiles,
+	FRDGTextureRef* InOutColorTexture)
+{
+	const FViewInfo& View = *Views[0];
+	const FIntPoint ColorAccumulationExtent = (*InOutColorTexture)->Desc.Extent;
+
+	// The splats of the traced tiles land anywhere, so the whole accumulation is resolved, but the texels of the other tiles keep what they hold
+	{
+		FRayTracingCausticsResolveCS::FParameters* ResolveParameters = GraphBuilder.AllocParameters<FRayTracingCausticsResolveCS::FParameters>();
+		ResolveParameters->ColorAccumulation = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(ColorAccumulationBuffer, PF_R32_UINT));
+		ResolveParameters->ColorAccumulationExtent = ColorAccumulationExtent;
+		ResolveParameters->ColorAccumulationScale = ColorAccumulationScale;
+		SetCausticsProgressiveTileParameters(ResolveParameters, ProgressiveTiles);
+		ResolveParameters->ColorOutput = GraphBuilder.CreateUAV(*InOutColorTexture);
+
+		TShaderMapRef<FRayTracingCausticsResolveCS> ResolveShader(View.ShaderMap);
+		FComputeShaderUtils::AddPass(
+			GraphBuilder,
+			RDG_EVENT_NAME("RayTracingCausticsResolve %dx%d", ColorAccumulationExtent.X, ColorAccumulationExtent.Y),
+			ResolveShader,
+			ResolveParameters,
+			FComputeShaderUtils::GetGroupCount(ColorAccumulationExtent, FRayTracingCausticsResolveCS::ThreadGroupSize));
+	}
+
+	// A still view keeps a plain running mean of what it shows instead of the temporal history, see r.RayTracing.Translucency.Accumulation
+	const bool bAccumulate = Views.Num() == 1 && IsRayTracingTranslucencyAccumulating(View);
+
+	if (CVarRayTracingCausticsTemporal.GetValueOnRenderThread() != 0 && !bAccumulate)
+	{
+		// Each view blends its own rect with its own history, a single view blends the whole texture as it always did
+		FCausticsTemporalOutputs TemporalOutputs;
+		for (const FViewInfo* TemporalView : Views)
+		{
+			const FIntRect Rect = Views.Num() > 1
+				? FIntRect(TemporalView->ViewRect.Min / UpscaleFactor, FIntPoint::DivideAndRoundUp(TemporalView->ViewRect.Max, UpscaleFactor))
+				: FIntRect(FIntPoint::ZeroValue, ColorAccumulationExtent);
+			AddCausticsTemporalPass(GraphBuilder, *TemporalView, SceneTextures, UpscaleFactor, *InOutColorTexture, Rect, ProgressiveTiles, TemporalOutputs);
+		}
+
+		if (TemporalOutputs.Color)
+		{
+			*InOutColorTexture = TemporalOutputs.Color;
+		}
+	}
+	else if (CVarRayTracingCausticsTemporal.GetValueOnRenderThread() == 0)
+	{
+		// Nothing reads the histories back, let their targets go
+		for (const FViewInfo* TemporalView : Views)
+		{
+			if (TemporalView->ViewState && !TemporalView->bStatePrevViewInfoIsReadOnly)
+			{
+				TemporalView->ViewState->PrevFrameViewInfo.RayTracingCausticsHistory = FRayTracingCausticsHistory();
+			}
+		}
+	}
+
+	// The filter runs after the temporal pass so that the history keeps the undenoised caustics
+	if (CVarRayTracingCausticsDenoiser.GetValueOnRenderThread() == 1)
+	{
+		AddCausticsDenoiserPasses(GraphBuilder, View, SceneTextures, UpscaleFactor, InOutColorTexture);
+	}
+
+	if (bAccumulate)
+	{
+		AddRayTracingTranslucencyAccumulationPass(GraphBuilder, View, FIntRect(FIntPoint::ZeroValue, ColorAccumulationExtent), TEXT("RayTracingCausticsAccumulation"), InOutColorTexture);
+	}
+}
+
 void FDeferredShadingSceneRenderer::PrepareRayTracingCaustics(const FViewInfo& View, TArray<FRHIRayTracingShader*>& OutRayGenShaders)
 {
 	// Declare all RayGen shaders that require material closest hit shaders to be bound
 	FRayTracingCausticsRGS::FPermutationDomain PermutationVector;
 	PermutationVector.Set<FRayTracingCausticsRGS::FEnableTwoSidedGeometryForShadowDim>(EnableRayTracingShadowTwoSidedGeometry());
-	auto RayGenShader = View.ShaderMap->GetShader<FRayTracingCausticsRGS>(PermutationVector);
-	OutRayGenShaders.Add(RayGenShader.GetRayTracingShader());
+	PermutationVector.Set<FRayTracingCausticsRGS::FLightSpaceEmissionDim>(UseRayTracingCausticsLightSpaceEmission());
+	if (UseRayTracingCausticsWavefront())
+	{
+		for (int32 Stage = 1; Stage <= CausticsWavefrontNumStages; ++Stage)
+		{
+			PermutationVector.Set<FRayTracingCausticsRGS::FWavefrontStageDim>(Stage);
+			auto RayGenShader = View.ShaderMap->GetShader<FRayTracingCausticsRGS>(PermutationVector);
+			OutRayGenShaders.Add(RayGenShader.GetRayTracingShader());
+		}
+	}
+	else
+	{
+		auto RayGenShader = View.ShaderMap->GetShader<FRayTracingCausticsRGS>(PermutationVector);
+		OutRayGenShaders.Add(RayGenShader.GetRayTracingShader());
+	}
+
 }
 
 
@@ -83,9 +962,11 @@ void FDeferredShadingSceneRenderer::RenderRayTracingCaustics(
 	FRDGTextureRef* InOutColorTexture,
 	FRDGTextureRef* InOutRayHitDistanceTexture,
 	FRDGTextureRef* InOutRayImaginaryDepthTexture,
+	FRDGTextureRef FirstHitTexture,
 	int32 SamplePerPixel,
 	int32 HeightFog,
-	float ResolutionFraction
+	float ResolutionFraction,
+	FRayTracingCausticsBatch* Batch
 )
 {
 
@@ -105,15 +986,38 @@ void FDeferredShadingSceneRenderer::RenderRayTracingCaustics(
 	Desc.Flags &= ~(TexCreate_FastVRAM | TexCreate_Transient);
 	Desc.Extent /= UpscaleFactor;
 	Desc.TargetableFlags |= TexCreate_UAV;
+
+	// The translucency hands over a color texture at its own resolution
+	if (*InOutColorTexture == nullptr || (*InOutColorTexture)->Desc.Extent != Desc.Extent)
+	{
+		*InOutColorTexture = GraphBuilder.CreateTexture(Desc, TEXT("RayTracingCaustics"));
+	}
+
+	// Progressive caustics resolve the texels of the tiles they trace into a color texture of their own, which keeps the other tiles from frame to frame.
+	// An accumulating view traces every tile every frame, its mean would count the others again.
+	const int32 RenderTileSize = CVarRayTracingCausticsRenderTileSize.GetValueOnRenderThread();
+	const bool bProgressive = GRayTracingCausticsProgressiveTilesPerFrame > 0
+		&& RenderTileSize > 0
+		&& !Batch
+		&& !IsRayTracingTranslucencyAccumulating(View)
+		&& !UseRayTracingCausticsLightSpaceEmission()
+		&& !UseRayTracingCausticsWavefront();
+	bool bProgressivePersisted = false;
+	if (bProgressive)
+	{
+		*InOutColorTexture = CreateRayTracingCausticsPersistentTexture(GraphBuilder, View, Desc, ERayTracingCausticsPersistentTexture::ProgressiveColor, TEXT("RayTracingCausticsProgressive"), &bProgressivePersisted);
+	}
+	FCausticsProgressiveTiles ProgressiveTiles;
+
 	Desc.Format = PF_R16F;
 
 	if (*InOutRayHitDistanceTexture == nullptr)
 	{
-		*InOutRayHitDistanceTexture = GraphBuilder.CreateTexture(Desc, TEXT("RayTracingCausticsHitDistance"));
+		*InOutRayHitDistanceTexture = CreateRayTracingCausticsPersistentTexture(GraphBuilder, View, Desc, ERayTracingCausticsPersistentTexture::HitDistance, TEXT("RayTracingCausticsHitDistance"));
 	}
 	if (*InOutRayImaginaryDepthTexture == nullptr)
 	{
-		*InOutRayImaginaryDepthTexture = GraphBuilder.CreateTexture(Desc, TEXT("RayTracingCausticsImaginaryDepth"));
+		*InOutRayImaginaryDepthTexture = CreateRayTracingCausticsPersistentTexture(GraphBuilder, View, Desc, ERayTracingCausticsPersistentTexture::ImaginaryDepth, TEXT("RayTracingCausticsImaginaryDepth"));
 	}
 
 	FRayTracingCausticsRGS::FParameters* PassParameters = GraphBuilder.AllocParameters<FRayTracingCausticsRGS::FParameters>();
@@ -126,6 +1030,9 @@ void FDeferredShadingSceneRenderer::RenderRayTracingCaustics(
 	PassParameters->ReflectedShadowsType = TranslucencyOptions.EnableShadows > -1 ? TranslucencyOptions.EnableShadows : (int32)View.FinalPostProcessSettings.RayTracingTranslucencyShadows;
 	PassParameters->ShouldDoEmissiveAndIndirectLighting = TranslucencyOptions.EnableEmmissiveAndIndirectLighting;
 	PassParameters->UpscaleFactor = UpscaleFactor;
+	PassParameters->RenderTileOffsetX = 0;
+	PassParameters->RenderTileOffsetY = 0;
+	PassParameters->AccumulationFrameIndex = GetRayTracingTranslucencyAccumulationFrameIndex(View);
 	PassParameters->TransmissionMinRayDistance = FMath::Min(TranslucencyOptions.MinRayDistance, TranslucencyOptions.MaxRayDistance);
 	PassParameters->TransmissionMaxRayDistance = TranslucencyOptions.MaxRayDistance;
 	PassParameters->TransmissionMaxRoughness = FMath::Clamp(TranslucencyOptions.MaxRoughness >= 0 ? TranslucencyOptions.MaxRoughness : View.FinalPostProcessSettings.RayTracingTranslucencyMaxRoughness, 0.01f, 1.0f);
@@ -133,6 +1040,7 @@ void FDeferredShadingSceneRenderer::RenderRayTracingCaustics(
 	PassParameters->MaxNormalBias = GetRaytracingMaxNormalBias();
 	PassParameters->ShouldUsePreExposure = View.Family->EngineShowFlags.Tonemapper;
 	PassParameters->TLAS = View.RayTracingScene.RayTracingSceneRHI->GetShaderResourceView();
+	PassParameters->TranslucentTLAS = GetRayTracingTranslucentSceneSRV(View);
 	PassParameters->ViewUniformBuffer = View.ViewUniformBuffer;
 
 	PassParameters->LightDataPacked = View.RayTracingLightingDataUniformBuffer;
@@ -147,10 +1055,43 @@ void FDeferredShadingSceneRenderer::RenderRayTracingCaustics(
 	PassParameters->ReflectionStruct = CreateReflectionUniformBuffer(View, EUniformBufferUsage::UniformBuffer_SingleFrame);
 	PassParameters->FogUniformParameters = CreateFogUniformBuffer(View, EUniformBufferUsage::UniformBuffer_SingleFrame);
 
-	PassParameters->ColorOutput = GraphBuilder.CreateUAV(*InOutColorTexture);
+	// Light half paths scatter into arbitrary pixels, so the color is accumulated in fixed point with atomics and resolved afterwards
+	const FIntPoint ColorAccumulationExtent = (*InOutColorTexture)->Desc.Extent;
+	const float ColorAccumulationScale = FMath::Max(GRayTracingCausticsAccumulationScale, 1.0f);
+	FRDGBufferRef ColorAccumulationBuffer = Batch ? Batch->ColorAccumulation : nullptr;
+	FRDGBufferUAVRef ColorAccumulationUAV = nullptr;
+	if (ColorAccumulationBuffer)
+	{
+		// The views of a batch splat into their own rect of the accumulation the first one cleared
+		ColorAccumulationUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(ColorAccumulationBuffer, PF_R32_UINT));
+	}
+	else
+	{
+		ColorAccumulationBuffer = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), ColorAccumulationExtent.X * ColorAccumulationExtent.Y * 4),
+			TEXT("RayTracingCausticsColorAccumulation"));
+		ColorAccumulationUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(ColorAccumulationBuffer, PF_R32_UINT));
+		AddClearUAVPass(GraphBuilder, ColorAccumulationUAV, 0);
+
+		if (Batch)
+		{
+			Batch->ColorAccumulation = ColorAccumulationBuffer;
+			Batch->ColorAccumulationScale = ColorAccumulationScale;
+			Batch->UpscaleFactor = UpscaleFactor;
+		}
+	}
+
+	PassParameters->ColorAccumulationOutput = ColorAccumulationUAV;
+	PassParameters->ColorAccumulationExtent = ColorAccumulationExtent;
+	PassParameters->ColorAccumulationScale = ColorAccumulationScale;
 	PassParameters->RayHitDistanceOutput = GraphBuilder.CreateUAV(*InOutRayHitDistanceTexture);
 	PassParameters->RayImaginaryDepthOutput = GraphBuilder.CreateUAV(*InOutRayImaginaryDepthTexture);
 
+	// The first hits are indexed by pixel, they are only written at full resolution
+	const bool bReuseFirstHit = FirstHitTexture != nullptr && UpscaleFactor == 1 && FirstHitTexture->Desc.Extent == (*InOutColorTexture)->Desc.Extent;
+	PassParameters->FirstHitTexture = bReuseFirstHit ? FirstHitTexture : GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
+	PassParameters->ReuseFirstHit = bReuseFirstHit ? 1 : 0;
+
 	// TODO: should be converted to RDG
 	TRefCountPtr<IPooledRenderTarget> SubsurfaceProfileRT((IPooledRenderTarget*)GetSubsufaceProfileTexture_RT(GraphBuilder.RHICmdList));
 	if (!SubsurfaceProfileRT)
@@ -159,27 +1100,299 @@ void FDeferredShadingSceneRenderer::RenderRayTracingCaustics(
 	}
 	PassParameters->SSProfilesTexture = GraphBuilder.RegisterExternalTexture(SubsurfaceProfileRT);
 
-	FRayTracingCausticsRGS::FPermutationDomain PermutationVector;
-	PermutationVector.Set<FRayTracingCausticsRGS::FEnableTwoSidedGeometryForShadowDim>(EnableRayTracingShadowTwoSidedGeometry());
-	auto RayGenShader = View.ShaderMap->GetShader<FRayTracingCausticsRGS>(PermutationVector);
+	// Light space emission dispatches one grid of rays per target, stacked along y, light culling tests the targets against the clusters
+	const bool bLightSpaceEmission = UseRayTracingCausticsLightSpaceEmission();
+	const bool bLightCulling = UseRayTracingCausticsLightCulling();
+	const uint32 LightSpaceResolution = FMath::Clamp(GRayTracingCausticsLightSpaceResolution, 1, 4096);
+	uint32 NumEmitterTargets = 0;
+	FShaderResourceViewRHIRef EmitterTargetsSRV;
+	if (Batch && Batch->EmitterTargetsSRV.IsValid())
+	{
+		// The instances of the family are the same for every view, the first view of the batch gathered them
+		NumEmitterTargets = Batch->NumEmitterTargets;
+		EmitterTargetsSRV = Batch->EmitterTargetsSRV;
+	}
+	else
+	{
+		TResourceArray<FVector4> EmitterTargets;
+		if (bLightSpaceEmission || bLightCulling)
+		{
+			GatherCausticsEmitterTargets(*Scene, View, EmitterTargets);
+		}
+		NumEmitterTargets = EmitterTargets.Num();
+		if (EmitterTargets.Num() == 0)
+		{
+			// Keep the SRV bindable
+			EmitterTargets.Add(FVector4(0.0f, 0.0f, 0.0f, 0.0f));
+		}
 
-	ClearUnusedGraphResources(RayGenShader, PassParameters);
+		FRHIResourceCreateInfo EmitterTargetsCreateInfo(&EmitterTargets);
+		FStructuredBufferRHIRef EmitterTargetsBuffer = RHICreateStructuredBuffer(sizeof(FVector4), EmitterTargets.GetResourceDataSize(), BUF_Static | BUF_ShaderResource, EmitterTargetsCreateInfo);
+		EmitterTargetsSRV = RHICreateShaderResourceView(EmitterTargetsBuffer);
 
-	GraphBuilder.AddPass(
-		RDG_EVENT_NAME("RayTracingCaustics %dx%d", RayTracingResolution.X, RayTracingResolution.Y),
-		PassParameters,
-		ERDGPassFlags::Compute,
-		[PassParameters, this, &View, RayGenShader, RayTracingResolution](FRHICommandList& RHICmdList)
+		if (Batch)
 		{
-			SCOPED_GPU_STAT(RHICmdList, RayTracingCaustics);
-			FRayTracingPipelineState* Pipeline = View.RayTracingMaterialPipeline;
+			Batch->EmitterTargetsSRV = EmitterTargetsSRV;
+			Batch->NumEmitterTargets = NumEmitterTargets;
+		}
+	}
+	PassParameters->CausticsEmitterTargets = EmitterTargetsSRV;
+	PassParameters->NumCausticsEmitterTargets = NumEmitterTargets;
+	PassParameters->LightSpaceResolution = LightSpaceResolution;
+
+	// One mask of CausticsLightCullingMaskWords per cluster, the slices of every tile are stacked along y
+	const FIntPoint LightCullingTileCount = FIntPoint::DivideAndRoundUp(RayTracingResolution, CausticsLightCullingTileSize);
+	const FIntPoint LightCullingResolution(LightCullingTileCount.X, LightCullingTileCount.Y * CausticsLightCullingNumSlices);
+	const int32 NumLightCullingClusters = bLightCulling ? LightCullingResolution.X * LightCullingResolution.Y : 1;
+	FRDGBufferRef LightMasksBuffer = GraphBuilder.CreateBuffer(
+		FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), NumLightCullingClusters * CausticsLightCullingMaskWords),
+		TEXT("RayTracingCausticsLightMasks"));
+	FRDGBufferUAVRef LightMasksUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(LightMasksBuffer, PF_R32_UINT));
+
+	if (bLightCulling && LightCullingResolution.X > 0 && LightCullingResolution.Y > 0)
+	{
+		FRayTracingCausticsLightCullingCS::FParameters* LightCullingParameters = GraphBuilder.AllocParameters<FRayTracingCausticsLightCullingCS::FParameters>();
+		LightCullingParameters->UpscaleFactor = UpscaleFactor;
+		LightCullingParameters->CausticsLightCullingTileCount = LightCullingTileCount;
+		LightCullingParameters->LightDataBuffer = View.RayTracingLightingDataSRV;
+		LightCullingParameters->CausticsEmitterTargets = EmitterTargetsSRV;
+		LightCullingParameters->NumCausticsEmitterTargets = NumEmitterTargets;
+		LightCullingParameters->ViewUniformBuffer = View.ViewUniformBuffer;
+		LightCullingParameters->CausticsLightMasksOutput = LightMasksUAV;
+
+		TShaderMapRef<FRayTracingCausticsLightCullingCS> LightCullingShader(View.ShaderMap);
+		FComputeShaderUtils::AddPass(
+			GraphBuilder,
+			RDG_EVENT_NAME("RayTracingCausticsLightCulling %dx%dx%d", LightCullingTileCount.X, LightCullingTileCount.Y, CausticsLightCullingNumSlices),
+			LightCullingShader,
+			LightCullingParameters,
+			FComputeShaderUtils::GetGroupCount(LightCullingResolution, FRayTracingCausticsLightCullingCS::ThreadGroupSize));
+	}
+	else
+	{
+		// Never read with culling disabled, cleared to keep it bindable
+		AddClearUAVPass(GraphBuilder, LightMasksUAV, 0);
+	}
+
+	PassParameters->CausticsLightMasks = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(LightMasksBuffer, PF_R32_UINT));
+	PassParameters->CausticsLightCulling = bLightCulling ? 1 : 0;
+	PassParameters->CausticsLightCullingTileCount = LightCullingTileCount;
+
+	// The alias table of the light selection is rebuilt every frame since it depends on the viewer
+	const int32 LightSamplesPerPixel = GetRayTracingCausticsLightSamplesPerPixel();
+	TResourceArray<FCausticsLightAliasEntry> LightAliasTable;
+	if (LightSamplesPerPixel > 0)
+	{
+		TArray<float> LightWeights;
+		GatherCausticsLightSelectionWeights(*Scene, View, LightWeights);
+		BuildCausticsLightAliasTable(LightWeights, LightAliasTable);
+	}
+	if (LightAliasTable.Num() == 0)
+	{
+		// Never read when every light is visited, keep the SRV bindable
+		LightAliasTable.Add(FCausticsLightAliasEntry{ 1.0f, 0, 0.0f, 0 });
+	}
+
+	FRHIResourceCreateInfo LightAliasTableCreateInfo(&LightAliasTable);
+	FStructuredBufferRHIRef LightAliasTableBuffer = RHICreateStructuredBuffer(sizeof(FCausticsLightAliasEntry), LightAliasTable.GetResourceDataSize(), BUF_Static | BUF_ShaderResource, LightAliasTableCreateInfo);
+	PassParameters->CausticsLightAliasTable = RHICreateShaderResourceView(LightAliasTableBuffer);
+	PassParameters->CausticsLightSamplesPerPixel = LightSamplesPerPixel;
+
+	// Adaptive sampling shares out the rough transmission samples by the variance the temporal pass measured last frame
+	const TRefCountPtr<IPooledRenderTarget>* HistoryVariance = nullptr;
+	if (CVarRayTracingCausticsAdaptiveSampling.GetValueOnRenderThread() != 0
+		&& CVarRayTracingCausticsTemporal.GetValueOnRenderThread() != 0
+		&& !bLightSpaceEmission
+		&& SamplePerPixel > 1)
+	{
+		HistoryVariance = FindCausticsHistoryVariance(View, ColorAccumulationExtent);
+	}
+
+	FRDGTextureRef VarianceTexture = GraphBuilder.RegisterExternalTexture(HistoryVariance ? *HistoryVariance : GSystemTextures.BlackDummy);
+	FRDGBufferRef VarianceSumBuffer = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 2), TEXT("RayTracingCausticsVarianceSum"));
+	FRDGBufferUAVRef VarianceSumUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(VarianceSumBuffer, PF_R32_UINT));
+	AddClearUAVPass(GraphBuilder, VarianceSumUAV, 0);
 
-			FRayTracingShaderBindingsWriter GlobalResources;
-			SetShaderParameters(GlobalResources, RayGenShader, *PassParameters);
+	if (HistoryVariance)
+	{
+		FRayTracingCausticsVarianceSumCS::FParameters* VarianceSumParameters = GraphBuilder.AllocParameters<FRayTracingCausticsVarianceSumCS::FParameters>();
+		VarianceSumParameters->CausticsVariance = VarianceTexture;
+		VarianceSumParameters->CausticsExtent = ColorAccumulationExtent;
+		VarianceSumParameters->CausticsVarianceSumOutput = VarianceSumUAV;
+
+		TShaderMapRef<FRayTracingCausticsVarianceSumCS> VarianceSumShader(View.ShaderMap);
+		FComputeShaderUtils::AddPass(
+			GraphBuilder,
+			RDG_EVENT_NAME("RayTracingCausticsVarianceSum %dx%d", ColorAccumulationExtent.X, ColorAccumulationExtent.Y),
+			VarianceSumShader,
+			VarianceSumParameters,
+			FComputeShaderUtils::GetGroupCount(ColorAccumulationExtent, FRayTracingCausticsVarianceSumCS::ThreadGroupSize));
+	}
+
+	PassParameters->CausticsVariance = VarianceTexture;
+	PassParameters->CausticsVarianceSum = GraphBuilder.CreateSRV(FRDGBufferSRVDesc(VarianceSumBuffer, PF_R32_UINT));
+	PassParameters->CausticsAdaptiveSampling = HistoryVariance ? 1 : 0;
+	PassParameters->CausticsMaxSamplesPerPixel = FMath::Max(GRayTracingCausticsAdaptiveSamplingMaxSamplesPerPixel, 1);
+
+	const FIntPoint DispatchResolution = bLightSpaceEmission
+		? FIntPoint(LightSpaceResolution, LightSpaceResolution * NumEmitterTargets)
+		: RayTracingResolution;
+
+	// EmitterTargetsSRV is captured to keep the buffer alive until the dispatch is recorded
+	auto AddCausticsDispatchPass = [&GraphBuilder, &View, bLightSpaceEmission, EmitterTargetsSRV](FRDGEventName&& PassName, FRayTracingCausticsRGS::FParameters* Parameters, int32 WavefrontStage, FIntPoint Resolution)
+	{
+		FRayTracingCausticsRGS::FPermutationDomain PermutationVector;
+		PermutationVector.Set<FRayTracingCausticsRGS::FEnableTwoSidedGeometryForShadowDim>(EnableRayTracingShadowTwoSidedGeometry());
+		PermutationVector.Set<FRayTracingCausticsRGS::FLightSpaceEmissionDim>(bLightSpaceEmission);
+		PermutationVector.Set<FRayTracingCausticsRGS::FWavefrontStageDim>(WavefrontStage);
+		auto RayGenShader = View.ShaderMap->GetShader<FRayTracingCausticsRGS>(PermutationVector);
+
+		ClearUnusedGraphResources(RayGenShader, Parameters);
+
+		if (Resolution.X > 0 && Resolution.Y > 0)
+		{
+			GraphBuilder.AddPass(
+				MoveTemp(PassName),
+				Parameters,
+				ERDGPassFlags::Compute,
+				[Parameters, &View, RayGenShader, Resolution, EmitterTargetsSRV](FRHICommandList& RHICmdList)
+				{
+					SCOPED_GPU_STAT(RHICmdList, RayTracingCaustics);
+					FRayTracingPipelineState* Pipeline = View.RayTracingMaterialPipeline;
+
+					FRayTracingShaderBindingsWriter GlobalResources;
+					SetShaderParameters(GlobalResources, RayGenShader, *Parameters);
+
+					FRHIRayTracingScene* RayTracingSceneRHI = View.RayTracingScene.RayTracingSceneRHI;
+					RHICmdList.RayTraceDispatch(Pipeline, RayGenShader.GetRayTracingShader(), RayTracingSceneRHI, GlobalResources, Resolution.X, Resolution.Y);
+				});
+		}
+	};
+
+	if (UseRayTracingCausticsWavefront())
+	{
+		// Ray tracing has no indirect dispatch, so every stage covers the capacity of its queue and the threads past the
+		// paths the previous stage kept leave at once, in whole waves
+		const int32 NumDispatchThreads = RayTracingResolution.X * RayTracingResolution.Y;
+		const int32 MaxTransmissionSamples = FMath::Max3(SamplePerPixel, PassParameters->CausticsAdaptiveSampling ? int32(PassParameters->CausticsMaxSamplesPerPixel) : 1, 1);
+		const int32 QueueCapacity = FMath::Max(FMath::CeilToInt(NumDispatchThreads * FMath::Max(GRayTracingCausticsWavefrontQueueItemsPerPixel, 0.0f)), 1);
+		const int32 ReceiverQueueCapacity = QueueCapacity * MaxTransmissionSamples;
+
+		FRDGBufferRef EntryQueue = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateStructuredDesc(CausticsEntryQueueItemSize, QueueCapacity), TEXT("RayTracingCausticsEntryQueue"));
+		FRDGBufferRef ExitQueue = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateStructuredDesc(CausticsExitQueueItemSize, QueueCapacity), TEXT("RayTracingCausticsExitQueue"));
+		FRDGBufferRef ReceiverQueue = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateStructuredDesc(CausticsReceiverQueueItemSize, ReceiverQueueCapacity), TEXT("RayTracingCausticsReceiverQueue"));
+		FRDGBufferRef QueueCounters = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), CausticsWavefrontNumQueues), TEXT("RayTracingCausticsQueueCounters"));
+		FRDGBufferUAVRef QueueCountersUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(QueueCounters, PF_R32_UINT));
+		AddClearUAVPass(GraphBuilder, QueueCountersUAV, 0);
+
+		PassParameters->CausticsEntryQueue = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(EntryQueue));
+		PassParameters->CausticsExitQueue = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(ExitQueue));
+		PassParameters->CausticsReceiverQueue = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(ReceiverQueue));
+		PassParameters->CausticsQueueCounters = QueueCountersUAV;
+		PassParameters->CausticsEntryQueueCapacity = QueueCapacity;
+		PassParameters->CausticsExitQueueCapacity = QueueCapacity;
+		PassParameters->CausticsReceiverQueueCapacity = ReceiverQueueCapacity;
+
+		static const TCHAR* const StageNames[] = { TEXT("Occlusion"), TEXT("Entry"), TEXT("Exit"), TEXT("Receiver") };
+		const int32 StageCapacities[] = { NumDispatchThreads, QueueCapacity, QueueCapacity, ReceiverQueueCapacity };
+		for (int32 Stage = 1; Stage <= CausticsWavefrontNumStages; ++Stage)
+		{
+			// Queues are laid out over rows of the screen dispatch
+			const FIntPoint StageResolution = Stage == 1
+				? DispatchResolution
+				: FIntPoint(DispatchResolution.X, FMath::DivideAndRoundUp(StageCapacities[Stage - 1], FMath::Max(DispatchResolution.X, 1)));
+
+			FRayTracingCausticsRGS::FParameters* StageParameters = GraphBuilder.AllocParameters<FRayTracingCausticsRGS::FParameters>();
+			*StageParameters = *PassParameters;
+			AddCausticsDispatchPass(
+				RDG_EVENT_NAME("RayTracingCaustics(Wavefront %s) %dx%d", StageNames[Stage - 1], StageResolution.X, StageResolution.Y),
+				StageParameters,
+				Stage,
+				StageResolution);
+		}
+	}
+	else if (RenderTileSize <= 0)
+	{
+		AddCausticsDispatchPass(
+			RDG_EVENT_NAME("RayTracingCaustics(%s) %dx%d", bLightSpaceEmission ? TEXT("LightSpace") : TEXT("Screen"), DispatchResolution.X, DispatchResolution.Y),
+			PassParameters,
+			0,
+			DispatchResolution);
+	}
+	else
+	{
+		// Like r.RayTracing.Reflections.RenderTileSize, every tile is a dispatch of its own so that none of them runs long enough to trigger timeout detection
+		const int32 TileSize = FMath::Max(RenderTileSize, 32);
+		const FIntPoint NumTiles = FIntPoint::DivideAndRoundUp(DispatchResolution, TileSize);
+		const int32 TotalNumTiles = NumTiles.X * NumTiles.Y;
+
+		int32 FirstTileIndex = 0;
+		int32 NumTracedTiles = TotalNumTiles;
+		if (bProgressivePersisted && !View.bCameraCut && TotalNumTiles > 0)
+		{
+			// The tiles are traced in turn, the others keep the caustics they were last resolved with.
+			// A persisted texture means the view state takes the history of this frame.
+			FirstTileIndex = View.PrevViewInfo.RayTracingCausticsHistory.ProgressiveTileIndex % TotalNumTiles;
+			NumTracedTiles = FMath::Min(GRayTracingCausticsProgressiveTilesPerFrame, TotalNumTiles);
+			View.ViewState->PrevFrameViewInfo.RayTracingCausticsHistory.ProgressiveTileIndex = (FirstTileIndex + NumTracedTiles) % TotalNumTiles;
+		}
+
+		if (NumTracedTiles < TotalNumTiles)
+		{
+			// The screen space caustics of a pixel splat at texels offset by the view rect like the dispatch, the tiles are laid out from there
+			ProgressiveTiles.Origin = View.ViewRect.Min;
+			ProgressiveTiles.TileSize = TileSize;
+			ProgressiveTiles.NumTilesX = NumTiles.X;
+			ProgressiveTiles.NumTiles = TotalNumTiles;
+			ProgressiveTiles.FirstTile = FirstTileIndex;
+			ProgressiveTiles.NumTracedTiles = NumTracedTiles;
+		}
+
+		for (int32 TracedTile = 0; TracedTile < NumTracedTiles; ++TracedTile)
+		{
+			const int32 TileIndex = (FirstTileIndex + TracedTile) % TotalNumTiles;
+			const FIntPoint TileOffset((TileIndex % NumTiles.X) * TileSize, (TileIndex / NumTiles.X) * TileSize);
+			const FIntPoint TileResolution = (DispatchResolution - TileOffset).ComponentMin(FIntPoint(TileSize, TileSize));
+
+			FRayTracingCausticsRGS::FParameters* TileParameters = PassParameters;
+			if (TracedTile > 0)
+			{
+				TileParameters = GraphBuilder.AllocParameters<FRayTracingCausticsRGS::FParameters>();
+				*TileParameters = *PassParameters;
+			}
+			TileParameters->RenderTileOffsetX = TileOffset.X;
+			TileParameters->RenderTileOffsetY = TileOffset.Y;
+
+			AddCausticsDispatchPass(
+				RDG_EVENT_NAME("RayTracingCaustics(%s) %dx%d", bLightSpaceEmission ? TEXT("LightSpace") : TEXT("Screen"), TileResolution.X, TileResolution.Y),
+				TileParameters,
+				0,
+				TileResolution);
+		}
+	}
+
+	// The views of a batch are resolved together once they have all been traced
+	if (Batch)
+	{
+		Batch->Views.Add(&View);
+		return;
+	}
+
+	const FViewInfo* const ResolveViews[] = { &View };
+	AddCausticsResolvePasses(GraphBuilder, MakeArrayView(ResolveViews), SceneTextures, UpscaleFactor, ColorAccumulationBuffer, ColorAccumulationScale, ProgressiveTiles, InOutColorTexture);
+}
+
+void FDeferredShadingSceneRenderer::FinishRayTracingCausticsBatch(FRDGBuilder& GraphBuilder, const FRayTracingCausticsBatch& Batch, FRDGTextureRef* InOutColorTexture)
+{
+	if (Batch.Views.Num() == 0)
+	{
+		return;
+	}
+
+	FSceneTextureParameters SceneTextures;
+	SetupSceneTextureParameters(GraphBuilder, &SceneTextures);
 
-			FRHIRayTracingScene* RayTracingSceneRHI = View.RayTracingScene.RayTracingSceneRHI;
-			RHICmdList.RayTraceDispatch(Pipeline, RayGenShader.GetRayTracingShader(), RayTracingSceneRHI, GlobalResources, RayTracingResolution.X, RayTracingResolution.Y);
-		});
+	AddCausticsResolvePasses(GraphBuilder, MakeArrayView(Batch.Views), SceneTextures, Batch.UpscaleFactor, Batch.ColorAccumulation, Batch.ColorAccumulationScale, FCausticsProgressiveTiles(), InOutColorTexture);
 }
 
 #endif
@@ -8,15 +8,127 @@
 #if RHI_RAYTRACING
 
 #include "ClearQuad.h"
+#include "ScenePrivate.h"
 #include "SceneRendering.h"
 #include "SceneRenderTargets.h"
 #include "RHIResources.h"
+#include "RenderGraphUtils.h"
 #include "PostProcess/PostProcessing.h"
 #include "RayTracing/RaytracingOptions.h"
 #include "Raytracing/RaytracingLighting.h"
+#include "RayTracing/RayTracingDeferredMaterials.h"
+#include "RayTracing/RayTracingTranslucencyHistory.h"
 
 DECLARE_GPU_STAT(RayTracingPrimaryRays);
 
+static TAutoConsoleVariable<int32> CVarRayTracingPrimaryRaysPathRegeneration(
+	TEXT("r.RayTracing.Translucency.PathRegeneration"),
+	0,
+	TEXT("Whether the refraction loop of the ray traced translucency runs on persistent threads that take the next pixel of the view as soon as their path is done.\n")
+	TEXT(" 0: one thread per pixel, a wave runs until its deepest path is done (default)\n")
+	TEXT(" 1: r.RayTracing.Translucency.PathRegeneration.Threads persistent threads, which keeps the waves full on scenes with a few deep refractive objects"),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingPrimaryRaysPathRegenerationThreads = 65536;
+static FAutoConsoleVariableRef CVarRayTracingPrimaryRaysPathRegenerationThreads(
+	TEXT("r.RayTracing.Translucency.PathRegeneration.Threads"),
+	GRayTracingPrimaryRaysPathRegenerationThreads,
+	TEXT("Persistent threads dispatched by the ray traced translucency with path regeneration, enough to fill the GPU. (default = 65536)"),
+	ECVF_RenderThreadSafe);
+
+// Width of the dispatch of the persistent threads, the pixels are handed out by a counter so the shape does not matter
+static const int32 PrimaryRaysPathRegenerationDispatchWidth = 256;
+
+static TAutoConsoleVariable<int32> CVarRayTracingPrimaryRaysSortMaterials(
+	TEXT("r.RayTracing.Translucency.SortMaterials"),
+	0,
+	TEXT("Sets whether the materials of the first refraction hits of the ray traced translucency are sorted before shading, like r.RayTracing.Reflections.SortMaterials\n")
+	TEXT("0: Disabled (Default)\n")
+	TEXT("1: Enabled, using Trace->Sort->Trace, replaces r.RayTracing.Translucency.PathRegeneration\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingPrimaryRaysSortTileSize(
+	TEXT("r.RayTracing.Translucency.SortTileSize"),
+	64,
+	TEXT("Size of pixel tiles for sorted translucency\n")
+	TEXT("  Default 64\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingPrimaryRaysSortSize(
+	TEXT("r.RayTracing.Translucency.SortSize"),
+	5,
+	TEXT("Size of horizon for material ID sort of the translucency\n")
+	TEXT("0: Disabled\n")
+	TEXT("1: 256 Elements\n")
+	TEXT("2: 512 Elements\n")
+	TEXT("3: 1024 Elements\n")
+	TEXT("4: 2048 Elements\n")
+	TEXT("5: 4096 Elements (Default)\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingPrimaryRaysRenderTileSize(
+	TEXT("r.RayTracing.Translucency.RenderTileSize"),
+	0,
+	TEXT("Render ray traced translucency in NxN pixel tiles, where each tile is dispatched on its own, allowing high quality rendering without triggering timeout detection.\n")
+	TEXT("Ignored with r.RayTracing.Translucency.SortMaterials and r.RayTracing.Translucency.PathRegeneration. (default = 0, tiling disabled)"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingPrimaryRaysCheckerboard(
+	TEXT("r.RayTracing.Translucency.Checkerboard"),
+	0,
+	TEXT("Whether the ray traced translucency only traces half of the pixels every frame.\n")
+	TEXT(" 0: every pixel is traced (default)\n")
+	TEXT(" 1: the pixels of a checkerboard that flips every frame are traced, the others are reconstructed from their traced neighbours and the reprojected history of the view"),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingPrimaryRaysRussianRouletteMinBounces = -1;
+static FAutoConsoleVariableRef CVarRayTracingPrimaryRaysRussianRouletteMinBounces(
+	TEXT("r.RayTracing.Translucency.RussianRoulette.MinBounces"),
+	GRayTracingPrimaryRaysRussianRouletteMinBounces,
+	TEXT("Refraction rays traced before the refraction loop of the ray traced translucency plays Russian roulette with the throughput of the path.\n")
+	TEXT("The paths that survive are reweighted, which keeps the translucency unbiased but adds noise. -1 disables it. (default = -1)"),
+	ECVF_RenderThreadSafe);
+
+static float GRayTracingPrimaryRaysMinPathThroughput = 0.0f;
+static FAutoConsoleVariableRef CVarRayTracingPrimaryRaysMinPathThroughput(
+	TEXT("r.RayTracing.Translucency.MinPathThroughput"),
+	GRayTracingPrimaryRaysMinPathThroughput,
+	TEXT("Throughput at or below which the refraction loop of the ray traced translucency stops, like after the last refraction ray. (default = 0)"),
+	ECVF_RenderThreadSafe);
+
+static float GRayTracingPrimaryRaysReflectionMinWeight = 0.0f;
+static FAutoConsoleVariableRef CVarRayTracingPrimaryRaysReflectionMinWeight(
+	TEXT("r.RayTracing.Translucency.ReflectionMinWeight"),
+	GRayTracingPrimaryRaysReflectionMinWeight,
+	TEXT("Weight in the pixel, from the Fresnel term, coverage and path throughput, below which the refraction loop of the ray traced translucency does not trace a reflection ray.\n")
+	TEXT("The reflection falls back to the sky light, or see r.RayTracing.Translucency.StochasticReflections. 0 always traces them. (default = 0)"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarRayTracingPrimaryRaysStochasticReflections(
+	TEXT("r.RayTracing.Translucency.StochasticReflections"),
+	0,
+	TEXT("What the ray traced translucency does with the reflection rays below r.RayTracing.Translucency.ReflectionMinWeight.\n")
+	TEXT(" 0: the reflection is the sky light in the reflected direction (default)\n")
+	TEXT(" 1: the reflection ray is traced with a probability proportional to its weight and reweighted, unbiased but noisier"),
+	ECVF_RenderThreadSafe);
+
+static bool ShouldRayTracingPrimaryRaysSortMaterials()
+{
+	return CVarRayTracingPrimaryRaysSortMaterials.GetValueOnRenderThread() != 0;
+}
+
+// Whether the translucency traces on a checkerboard, for the views that have a state to keep its history in
+bool UseRayTracingPrimaryRaysCheckerboard()
+{
+	return CVarRayTracingPrimaryRaysCheckerboard.GetValueOnRenderThread() != 0;
+}
+
+static bool UseRayTracingPrimaryRaysPathRegeneration()
+{
+	// The persistent threads take the pixels in order, sorting takes them in material order instead
+	return CVarRayTracingPrimaryRaysPathRegeneration.GetValueOnRenderThread() != 0 && !ShouldRayTracingPrimaryRaysSortMaterials();
+}
+
 class FRayTracingPrimaryRaysRGS : public FGlobalShader
 {
 	DECLARE_GLOBAL_SHADER(FRayTracingPrimaryRaysRGS)
@@ -25,8 +137,10 @@ class FRayTracingPrimaryRaysRGS : public FGlobalShader
 		class FDenoiserOutput : SHADER_PERMUTATION_BOOL("DIM_DENOISER_OUTPUT");
 	class FEnableTwoSidedGeometryForShadowDim : SHADER_PERMUTATION_BOOL("ENABLE_TWO_SIDED_GEOMETRY");
 	class FMissShaderLighting : SHADER_PERMUTATION_BOOL("DIM_MISS_SHADER_LIGHTING");
+	class FPathRegeneration : SHADER_PERMUTATION_BOOL("DIM_PATH_REGENERATION");
+	class FDeferredMaterialMode : SHADER_PERMUTATION_ENUM_CLASS("DIM_DEFERRED_MATERIAL_MODE", EDeferredMaterialMode);
 
-	using FPermutationDomain = TShaderPermutationDomain<FDenoiserOutput, FEnableTwoSidedGeometryForShadowDim, FMissShaderLighting>;
+	using FPermutationDomain = TShaderPermutationDomain<FDenoiserOutput, FEnableTwoSidedGeometryForShadowDim, FMissShaderLighting, FPathRegeneration, FDeferredMaterialMode>;
 
 	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
 		SHADER_PARAMETER(int32, SamplesPerPixel)
@@ -43,6 +157,20 @@ class FRayTracingPrimaryRaysRGS : public FGlobalShader
 		SHADER_PARAMETER(float, TranslucencyMaxRoughness)
 		SHADER_PARAMETER(int32, TranslucencyRefraction)
 		SHADER_PARAMETER(float, MaxNormalBias)
+		SHADER_PARAMETER(int32, RussianRouletteMinBounces)
+		SHADER_PARAMETER(float, MinPathThroughput)
+		SHADER_PARAMETER(float, ReflectionMinWeight)
+		SHADER_PARAMETER(int32, StochasticReflections)
+		SHADER_PARAMETER(FIntPoint, PathRegenerationResolution)
+		SHADER_PARAMETER(int32, SortTileSize)
+		SHADER_PARAMETER(FIntPoint, RayTracingResolution)
+		SHADER_PARAMETER(FIntPoint, TileAlignedResolution)
+		SHADER_PARAMETER(uint32, RenderTileOffsetX)
+		SHADER_PARAMETER(uint32, RenderTileOffsetY)
+		SHADER_PARAMETER(uint32, AccumulationFrameIndex)
+		SHADER_PARAMETER(uint32, Checkerboard)
+		SHADER_PARAMETER(uint32, CheckerboardParity)
+		SHADER_PARAMETER(FIntPoint, CheckerboardResolution)
 
 		SHADER_PARAMETER_SRV(RaytracingAccelerationStructure, TLAS)
 		SHADER_PARAMETER_SRV(StructuredBuffer<FRTLightingData>, LightDataBuffer)
@@ -63,16 +191,143 @@ class FRayTracingPrimaryRaysRGS : public FGlobalShader
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, CausticsColorOutput)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, RayHitDistanceOutput)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, RayImaginaryDepthOutput)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, PathRegenerationCounter)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<uint2>, FirstHitOutput)
+		SHADER_PARAMETER(uint32, FirstHitOutputEnabled)
+
+		// Optional indirection buffer used for sorted materials
+		SHADER_PARAMETER_RDG_BUFFER_UAV(StructuredBuffer<FDeferredMaterialPayload>, MaterialBuffer)
 		END_SHADER_PARAMETER_STRUCT()
 
 		static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
 	{
+		FPermutationDomain PermutationVector(Parameters.PermutationId);
+		if (PermutationVector.Get<FPathRegeneration>() && PermutationVector.Get<FDeferredMaterialMode>() != EDeferredMaterialMode::None)
+		{
+			return false;
+		}
+
 		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
 	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+
+		FPermutationDomain PermutationVector(Parameters.PermutationId);
+
+		if (PermutationVector.Get<FDeferredMaterialMode>() == EDeferredMaterialMode::Shade)
+		{
+			OutEnvironment.SetDefine(TEXT("UE_RAY_TRACING_DISPATCH_1D"), 1);
+		}
+
+		if (PermutationVector.Get<FDeferredMaterialMode>() == EDeferredMaterialMode::Gather)
+		{
+			OutEnvironment.SetDefine(TEXT("UE_RAY_TRACING_LIGHTWEIGHT_CLOSEST_HIT_SHADER"), 1);
+		}
+	}
 };
 
 IMPLEMENT_GLOBAL_SHADER(FRayTracingPrimaryRaysRGS, "/Engine/Private/RayTracing/RayTracingPrimaryRays.usf", "RayTracingPrimaryRaysRGS", SF_RayGen);
 
+class FRayTracingPrimaryRaysCheckerboardCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FRayTracingPrimaryRaysCheckerboardCS)
+	SHADER_USE_PARAMETER_STRUCT(FRayTracingPrimaryRaysCheckerboardCS, FGlobalShader)
+
+	static const uint32 ThreadGroupSize = 8;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, ColorTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, RayHitDistanceTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, RayImaginaryDepthTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, HistoryColorTexture)
+		SHADER_PARAMETER_SAMPLER(SamplerState, HistorySampler)
+		SHADER_PARAMETER(uint32, HistoryValid)
+		SHADER_PARAMETER(uint32, CheckerboardParity)
+		SHADER_PARAMETER(uint32, UpscaleFactor)
+		SHADER_PARAMETER(FIntPoint, RayTracingResolution)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FSceneTextureParameters, SceneTextures)
+		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, ViewUniformBuffer)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, ColorOutput)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, RayHitDistanceOutput)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, RayImaginaryDepthOutput)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FRayTracingPrimaryRaysCheckerboardCS, "/Engine/Private/RayTracing/RayTracingPrimaryRaysCheckerboard.usf", "RayTracingPrimaryRaysCheckerboardCS", SF_Compute);
+
+// Fills the pixels the checkerboard of this frame skipped, and replaces the three textures with the full resolution result
+static void AddPrimaryRaysCheckerboardPass(
+	FRDGBuilder& GraphBuilder,
+	const FViewInfo& View,
+	const FSceneTextureParameters& SceneTextures,
+	int32 UpscaleFactor,
+	FIntPoint RayTracingResolution,
+	uint32 CheckerboardParity,
+	FRDGTextureRef* InOutColorTexture,
+	FRDGTextureRef* InOutRayHitDistanceTexture,
+	FRDGTextureRef* InOutRayImaginaryDepthTexture)
+{
+	// The checkerboard is only used by views with a state, see RenderRayTracingPrimaryRaysView()
+	check(View.ViewState);
+	const FRayTracingPrimaryRaysCheckerboardHistory& History = View.PrevViewInfo.RayTracingPrimaryRaysCheckerboardHistory;
+	const FPooledRenderTargetDesc& ColorDesc = (*InOutColorTexture)->Desc;
+	const bool bHistoryValid = History.Color.IsValid()
+		&& History.Color->GetDesc().Extent == ColorDesc.Extent
+		&& !View.bCameraCut
+		&& !View.bPrevTransformsReset;
+
+	FRDGTextureRef ColorOutput = GraphBuilder.CreateTexture(ColorDesc, TEXT("RayTracingTranslucentCheckerboard"));
+	FRDGTextureRef RayHitDistanceOutput = GraphBuilder.CreateTexture((*InOutRayHitDistanceTexture)->Desc, TEXT("RayTracingPrimaryRaysCheckerboardHitDistance"));
+	FRDGTextureRef RayImaginaryDepthOutput = GraphBuilder.CreateTexture((*InOutRayImaginaryDepthTexture)->Desc, TEXT("RayTracingPrimaryRaysCheckerboardImaginaryDepth"));
+
+	FRayTracingPrimaryRaysCheckerboardCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FRayTracingPrimaryRaysCheckerboardCS::FParameters>();
+	PassParameters->ColorTexture = *InOutColorTexture;
+	PassParameters->RayHitDistanceTexture = *InOutRayHitDistanceTexture;
+	PassParameters->RayImaginaryDepthTexture = *InOutRayImaginaryDepthTexture;
+	PassParameters->HistoryColorTexture = GraphBuilder.RegisterExternalTexture(bHistoryValid ? History.Color : GSystemTextures.BlackDummy);
+	PassParameters->HistorySampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+	PassParameters->HistoryValid = bHistoryValid ? 1 : 0;
+	PassParameters->CheckerboardParity = CheckerboardParity;
+	PassParameters->UpscaleFactor = UpscaleFactor;
+	PassParameters->RayTracingResolution = RayTracingResolution;
+	PassParameters->SceneTextures = SceneTextures;
+	PassParameters->ViewUniformBuffer = View.ViewUniformBuffer;
+	PassParameters->ColorOutput = GraphBuilder.CreateUAV(ColorOutput);
+	PassParameters->RayHitDistanceOutput = GraphBuilder.CreateUAV(RayHitDistanceOutput);
+	PassParameters->RayImaginaryDepthOutput = GraphBuilder.CreateUAV(RayImaginaryDepthOutput);
+
+	TShaderMapRef<FRayTracingPrimaryRaysCheckerboardCS> CheckerboardShader(View.ShaderMap);
+	FComputeShaderUtils::AddPass(
+		GraphBuilder,
+		RDG_EVENT_NAME("RayTracingPrimaryRaysCheckerboard %dx%d", RayTracingResolution.X, RayTracingResolution.Y),
+		CheckerboardShader,
+		PassParameters,
+		FComputeShaderUtils::GetGroupCount(RayTracingResolution, FRayTracingPrimaryRaysCheckerboardCS::ThreadGroupSize));
+
+	// A view rendered several times in a frame only keeps the history of its first render
+	if (!View.bStatePrevViewInfoIsReadOnly)
+	{
+		GraphBuilder.QueueTextureExtraction(ColorOutput, &View.ViewState->PrevFrameViewInfo.RayTracingPrimaryRaysCheckerboardHistory.Color);
+	}
+
+	*InOutColorTexture = ColorOutput;
+	*InOutRayHitDistanceTexture = RayHitDistanceOutput;
+	*InOutRayImaginaryDepthTexture = RayImaginaryDepthOutput;
+}
+
 void FDeferredShadingSceneRenderer::PrepareRayTracingTranslucency(const FViewInfo& View, TArray<FRHIRayTracingShader*>& OutRayGenShaders)
 {
 	// Declare all RayGen shaders that require material closest hit shaders to be bound
@@ -83,11 +338,24 @@ void FDeferredShadingSceneRenderer::PrepareRayTracingTranslucency(const FViewInf
 	PermutationVector.Set<FRayTracingPrimaryRaysRGS::FMissShaderLighting>(bLightingMissShader);
 
 	PermutationVector.Set<FRayTracingPrimaryRaysRGS::FEnableTwoSidedGeometryForShadowDim>(EnableRayTracingShadowTwoSidedGeometry());
+	PermutationVector.Set<FRayTracingPrimaryRaysRGS::FPathRegeneration>(UseRayTracingPrimaryRaysPathRegeneration());
+
+	if (ShouldRayTracingPrimaryRaysSortMaterials())
+	{
+		PermutationVector.Set<FRayTracingPrimaryRaysRGS::FDeferredMaterialMode>(EDeferredMaterialMode::Gather);
+		auto GatherShader = View.ShaderMap->GetShader<FRayTracingPrimaryRaysRGS>(PermutationVector);
+		OutRayGenShaders.Add(GatherShader.GetRayTracingShader());
+
+		PermutationVector.Set<FRayTracingPrimaryRaysRGS::FDeferredMaterialMode>(EDeferredMaterialMode::Shade);
+	}
 
 	auto RayGenShader = View.ShaderMap->GetShader<FRayTracingPrimaryRaysRGS>(PermutationVector);
 	OutRayGenShaders.Add(RayGenShader.GetRayTracingShader());
 }
 
+extern FRDGTextureRef CreateRayTracingCausticsPersistentTexture(FRDGBuilder& GraphBuilder, const FViewInfo& View, FPooledRenderTargetDesc Desc, ERayTracingCausticsPersistentTexture::Type Slot, const TCHAR* Name, bool* bOutPersisted = nullptr);
+extern uint32 GetRayTracingTranslucencyAccumulationFrameIndex(const FViewInfo& View);
+
 void FDeferredShadingSceneRenderer::RenderRayTracingPrimaryRaysView(
 	FRDGBuilder& GraphBuilder,
 	const FViewInfo& View,
@@ -99,7 +367,8 @@ void FDeferredShadingSceneRenderer::RenderRayTracingPrimaryRaysView(
 	int32 SamplePerPixel,
 	int32 HeightFog,
 	float ResolutionFraction,
-	ERayTracingPrimaryRaysFlag Flags)
+	ERayTracingPrimaryRaysFlag Flags,
+	FRDGTextureRef* OutFirstHitTexture)
 {
 	FSceneRenderTargets& SceneContext = FSceneRenderTargets::Get(GraphBuilder.RHICmdList);
 
@@ -132,7 +401,7 @@ void FDeferredShadingSceneRenderer::RenderRayTracingPrimaryRaysView(
 
 		if (*InOutCausticsColorTexture == nullptr)
 		{
-			*InOutCausticsColorTexture = GraphBuilder.CreateTexture(Desc, TEXT("RayTracingCaustics"));
+			*InOutCausticsColorTexture = CreateRayTracingCausticsPersistentTexture(GraphBuilder, View, Desc, ERayTracingCausticsPersistentTexture::TranslucencyColor, TEXT("RayTracingCaustics"));
 		}
 
 		Desc.Format = PF_R16F;
@@ -157,11 +426,18 @@ void FDeferredShadingSceneRenderer::RenderRayTracingPrimaryRaysView(
 	PassParameters->ReflectedShadowsType = TranslucencyOptions.EnableShadows > -1 ? TranslucencyOptions.EnableShadows : (int32)View.FinalPostProcessSettings.RayTracingTranslucencyShadows;
 	PassParameters->ShouldDoEmissiveAndIndirectLighting = TranslucencyOptions.EnableEmmissiveAndIndirectLighting;
 	PassParameters->UpscaleFactor = UpscaleFactor;
+	PassParameters->RenderTileOffsetX = 0;
+	PassParameters->RenderTileOffsetY = 0;
+	PassParameters->AccumulationFrameIndex = GetRayTracingTranslucencyAccumulationFrameIndex(View);
 	PassParameters->TranslucencyMinRayDistance = FMath::Min(TranslucencyOptions.MinRayDistance, TranslucencyOptions.MaxRayDistance);
 	PassParameters->TranslucencyMaxRayDistance = TranslucencyOptions.MaxRayDistance;
 	PassParameters->TranslucencyMaxRoughness = FMath::Clamp(TranslucencyOptions.MaxRoughness >= 0 ? TranslucencyOptions.MaxRoughness : View.FinalPostProcessSettings.RayTracingTranslucencyMaxRoughness, 0.01f, 1.0f);
 	PassParameters->TranslucencyRefraction = TranslucencyOptions.EnableRefraction >= 0 ? TranslucencyOptions.EnableRefraction : View.FinalPostProcessSettings.RayTracingTranslucencyRefraction;
 	PassParameters->MaxNormalBias = GetRaytracingMaxNormalBias();
+	PassParameters->RussianRouletteMinBounces = GRayTracingPrimaryRaysRussianRouletteMinBounces;
+	PassParameters->MinPathThroughput = FMath::Clamp(GRayTracingPrimaryRaysMinPathThroughput, 0.0f, 1.0f);
+	PassParameters->ReflectionMinWeight = FMath::Max(GRayTracingPrimaryRaysReflectionMinWeight, 0.0f);
+	PassParameters->StochasticReflections = CVarRayTracingPrimaryRaysStochasticReflections.GetValueOnRenderThread();
 	PassParameters->ShouldUsePreExposure = View.Family->EngineShowFlags.Tonemapper;
 	PassParameters->PrimaryRayFlags = (uint32)Flags;
 	PassParameters->TLAS = View.RayTracingScene.RayTracingSceneRHI->GetShaderResourceView();
@@ -192,25 +468,171 @@ void FDeferredShadingSceneRenderer::RenderRayTracingPrimaryRaysView(
 	PermutationVector.Set<FRayTracingPrimaryRaysRGS::FEnableTwoSidedGeometryForShadowDim>(EnableRayTracingShadowTwoSidedGeometry());
 	PermutationVector.Set< FRayTracingPrimaryRaysRGS::FMissShaderLighting>(bMissShaderLighting);
 
+	// With the checkerboard every thread traces one pixel of a horizontal pair, views without a state have no history to reconstruct from
+	const bool bCheckerboard = UseRayTracingPrimaryRaysCheckerboard() && View.ViewState != nullptr;
+	const uint32 CheckerboardParity = bCheckerboard ? View.ViewState->GetFrameIndex() & 1 : 0;
+	const FIntPoint TraceResolution = bCheckerboard ? FIntPoint(FMath::DivideAndRoundUp(RayTracingResolution.X, 2), RayTracingResolution.Y) : RayTracingResolution;
+	PassParameters->Checkerboard = bCheckerboard ? 1 : 0;
+	PassParameters->CheckerboardParity = CheckerboardParity;
+	PassParameters->CheckerboardResolution = RayTracingResolution;
+
+	// With path regeneration the persistent threads take the pixels in order from a counter, the dispatch only has to fill the GPU
+	const bool bSortMaterials = ShouldRayTracingPrimaryRaysSortMaterials();
+	const bool bPathRegeneration = UseRayTracingPrimaryRaysPathRegeneration();
+	FIntPoint DispatchResolution = TraceResolution;
+	PassParameters->PathRegenerationResolution = TraceResolution;
+	PassParameters->RayTracingResolution = TraceResolution;
+	if (bSortMaterials)
+	{
+		// Like the reflections, a first pass gathers the material of the first refraction hit of every pixel and sorts the
+		// pixels by it, the second pass re-traces that ray shortened around the hit and shades the whole path
+		const uint32 SortTileSize = CVarRayTracingPrimaryRaysSortTileSize.GetValueOnRenderThread();
+		FIntPoint TileAlignedResolution = TraceResolution;
+		if (SortTileSize)
+		{
+			TileAlignedResolution = FIntPoint::DivideAndRoundUp(TraceResolution, SortTileSize) * SortTileSize;
+		}
+		const uint32 DeferredMaterialBufferNumElements = TileAlignedResolution.X * TileAlignedResolution.Y;
+
+		PassParameters->SortTileSize = SortTileSize;
+		PassParameters->TileAlignedResolution = TileAlignedResolution;
+
+		FRDGBufferDesc Desc = FRDGBufferDesc::CreateStructuredDesc(sizeof(FDeferredMaterialPayload), DeferredMaterialBufferNumElements);
+		FRDGBufferRef DeferredMaterialBuffer = GraphBuilder.CreateBuffer(Desc, TEXT("RayTracingPrimaryRaysMaterialBuffer"));
+
+		FRayTracingPrimaryRaysRGS::FParameters* GatherPassParameters = GraphBuilder.AllocParameters<FRayTracingPrimaryRaysRGS::FParameters>();
+		*GatherPassParameters = *PassParameters;
+		GatherPassParameters->MaterialBuffer = GraphBuilder.CreateUAV(DeferredMaterialBuffer);
+
+		FRayTracingPrimaryRaysRGS::FPermutationDomain GatherPermutationVector = PermutationVector;
+		GatherPermutationVector.Set<FRayTracingPrimaryRaysRGS::FDeferredMaterialMode>(EDeferredMaterialMode::Gather);
+		auto GatherShader = View.ShaderMap->GetShader<FRayTracingPrimaryRaysRGS>(GatherPermutationVector);
+
+		ClearUnusedGraphResources(GatherShader, GatherPassParameters);
+
+		GraphBuilder.AddPass(
+			RDG_EVENT_NAME("RayTracingPrimaryRaysGatherMaterials %dx%d", TileAlignedResolution.X, TileAlignedResolution.Y),
+			GatherPassParameters,
+			ERDGPassFlags::Compute,
+			[GatherPassParameters, &View, GatherShader, TileAlignedResolution](FRHICommandList& RHICmdList)
+			{
+				SCOPED_GPU_STAT(RHICmdList, RayTracingPrimaryRays);
+				FRayTracingPipelineState* Pipeline = BindRayTracingDeferredMaterialGatherPipeline(RHICmdList, View, GatherShader.GetRayTracingShader());
+
+				FRayTracingShaderBindingsWriter GlobalResources;
+				SetShaderParameters(GlobalResources, GatherShader, *GatherPassParameters);
+
+				FRHIRayTracingScene* RayTracingSceneRHI = View.RayTracingScene.RayTracingSceneRHI;
+				RHICmdList.RayTraceDispatch(Pipeline, GatherShader.GetRayTracingShader(), RayTracingSceneRHI, GlobalResources, TileAlignedResolution.X, TileAlignedResolution.Y);
+			});
+
+		// A material sorting pass
+		const uint32 SortSize = CVarRayTracingPrimaryRaysSortSize.GetValueOnRenderThread();
+		if (SortSize)
+		{
+			SortDeferredMaterials(GraphBuilder, View, SortSize, DeferredMaterialBufferNumElements, DeferredMaterialBuffer);
+		}
+
+		// Shading pass for sorted materials uses 1D dispatch over all elements in the material buffer.
+		PassParameters->MaterialBuffer = GraphBuilder.CreateUAV(DeferredMaterialBuffer);
+		PermutationVector.Set<FRayTracingPrimaryRaysRGS::FDeferredMaterialMode>(EDeferredMaterialMode::Shade);
+		DispatchResolution = FIntPoint(DeferredMaterialBufferNumElements, 1);
+	}
+	else if (bPathRegeneration)
+	{
+		const int32 NumPixels = TraceResolution.X * TraceResolution.Y;
+		const int32 NumThreads = FMath::Clamp(GRayTracingPrimaryRaysPathRegenerationThreads, 1, FMath::Max(NumPixels, 1));
+		DispatchResolution = FIntPoint(PrimaryRaysPathRegenerationDispatchWidth, FMath::DivideAndRoundUp(NumThreads, PrimaryRaysPathRegenerationDispatchWidth));
+
+		FRDGBufferRef PathRegenerationCounter = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 1), TEXT("RayTracingPrimaryRaysPathRegenerationCounter"));
+		FRDGBufferUAVRef PathRegenerationCounterUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(PathRegenerationCounter, PF_R32_UINT));
+		AddClearUAVPass(GraphBuilder, PathRegenerationCounterUAV, 0);
+		PassParameters->PathRegenerationCounter = PathRegenerationCounterUAV;
+	}
+	PermutationVector.Set<FRayTracingPrimaryRaysRGS::FPathRegeneration>(bPathRegeneration);
+
+	// The first hits stand for the camera rays of the caustics, so every pixel must have traced its own, up to the G-buffer
+	const bool bFirstHitOutput = OutFirstHitTexture != nullptr
+		&& UpscaleFactor == 1
+		&& !bCheckerboard
+		&& EnumHasAnyFlags(Flags, ERayTracingPrimaryRaysFlag::UseGBufferForMaxDistance);
+	FRDGTextureRef FirstHitTexture = nullptr;
+	{
+		FPooledRenderTargetDesc Desc = (*InOutColorTexture)->Desc;
+		Desc.Format = PF_R32G32_UINT;
+		if (!bFirstHitOutput)
+		{
+			// Keep the UAV bindable
+			Desc.Extent = FIntPoint(1, 1);
+		}
+		FirstHitTexture = GraphBuilder.CreateTexture(Desc, TEXT("RayTracingPrimaryRaysFirstHit"));
+	}
+	PassParameters->FirstHitOutput = GraphBuilder.CreateUAV(FirstHitTexture);
+	PassParameters->FirstHitOutputEnabled = bFirstHitOutput ? 1 : 0;
+
 	auto RayGenShader = View.ShaderMap->GetShader<FRayTracingPrimaryRaysRGS>(PermutationVector);
 
 	ClearUnusedGraphResources(RayGenShader, PassParameters);
 
-	GraphBuilder.AddPass(
-		RDG_EVENT_NAME("RayTracingPrimaryRays %dx%d", RayTracingResolution.X, RayTracingResolution.Y),
-		PassParameters,
-		ERDGPassFlags::Compute,
-		[PassParameters, this, &View, RayGenShader, RayTracingResolution](FRHICommandList& RHICmdList)
+	// Add optional tiling behavior to avoid TDR events in expensive passes, the sorted and regenerated paths do not map the dispatch to the pixels
+	int32 RenderTileSize = CVarRayTracingPrimaryRaysRenderTileSize.GetValueOnRenderThread();
+	if (bSortMaterials || bPathRegeneration || RenderTileSize <= 0)
+	{
+		RenderTileSize = FMath::Max3(DispatchResolution.X, DispatchResolution.Y, 1);
+	}
+	else
+	{
+		RenderTileSize = FMath::Max(RenderTileSize, 32);
+	}
+
+	const int32 NumTilesX = FMath::DivideAndRoundUp(DispatchResolution.X, RenderTileSize);
+	const int32 NumTilesY = FMath::DivideAndRoundUp(DispatchResolution.Y, RenderTileSize);
+	for (int32 Y = 0; Y < NumTilesY; ++Y)
+	{
+		for (int32 X = 0; X < NumTilesX; ++X)
 		{
-			SCOPED_GPU_STAT(RHICmdList, RayTracingPrimaryRays);
-			FRayTracingPipelineState* Pipeline = View.RayTracingMaterialPipeline;
+			FRayTracingPrimaryRaysRGS::FParameters* TilePassParameters = PassParameters;
+			if (X > 0 || Y > 0)
+			{
+				TilePassParameters = GraphBuilder.AllocParameters<FRayTracingPrimaryRaysRGS::FParameters>();
+				*TilePassParameters = *PassParameters;
+				TilePassParameters->RenderTileOffsetX = X * RenderTileSize;
+				TilePassParameters->RenderTileOffsetY = Y * RenderTileSize;
+			}
+
+			const FIntPoint TileResolution(
+				FMath::Min<int32>(RenderTileSize, DispatchResolution.X - TilePassParameters->RenderTileOffsetX),
+				FMath::Min<int32>(RenderTileSize, DispatchResolution.Y - TilePassParameters->RenderTileOffsetY));
+
+			GraphBuilder.AddPass(
+				RDG_EVENT_NAME("RayTracingPrimaryRays%s%s %dx%d", bSortMaterials ? TEXT("(SortedMaterials)") : bPathRegeneration ? TEXT("(PathRegeneration)") : TEXT(""), bCheckerboard ? TEXT("(Checkerboard)") : TEXT(""), TileResolution.X, TileResolution.Y),
+				TilePassParameters,
+				ERDGPassFlags::Compute,
+				[TilePassParameters, this, &View, RayGenShader, TileResolution](FRHICommandList& RHICmdList)
+				{
+					SCOPED_GPU_STAT(RHICmdList, RayTracingPrimaryRays);
+					FRayTracingPipelineState* Pipeline = View.RayTracingMaterialPipeline;
+
+					FRayTracingShaderBindingsWriter GlobalResources;
+					SetShaderParameters(GlobalResources, RayGenShader, *TilePassParameters);
+
+					FRHIRayTracingScene* RayTracingSceneRHI = View.RayTracingScene.RayTracingSceneRHI;
+					RHICmdList.RayTraceDispatch(Pipeline, RayGenShader.GetRayTracingShader(), RayTracingSceneRHI, GlobalResources, TileResolution.X, TileResolution.Y);
+				});
+		}
+	}
 
-			FRayTracingShaderBindingsWriter GlobalResources;
-			SetShaderParameters(GlobalResources, RayGenShader, *PassParameters);
+	if (bFirstHitOutput)
+	{
+		*OutFirstHitTexture = FirstHitTexture;
+	}
 
-			FRHIRayTracingScene* RayTracingSceneRHI = View.RayTracingScene.RayTracingSceneRHI;
-			RHICmdList.RayTraceDispatch(Pipeline, RayGenShader.GetRayTracingShader(), RayTracingSceneRHI, GlobalResources, RayTracingResolution.X, RayTracingResolution.Y);
-		});
+	if (bCheckerboard)
+	{
+		AddPrimaryRaysCheckerboardPass(
+			GraphBuilder, View, SceneTextures, UpscaleFactor, RayTracingResolution, CheckerboardParity,
+			InOutColorTexture, InOutRayHitDistanceTexture, InOutRayImaginaryDepthTexture);
+	}
 }
 
 #endif // RHI_RAYTRACING
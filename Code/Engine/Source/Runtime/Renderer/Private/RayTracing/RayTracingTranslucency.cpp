@@ -8,9 +8,11 @@
 #if RHI_RAYTRACING
 
 #include "ClearQuad.h"
+#include "ScenePrivate.h"
 #include "SceneRendering.h"
 #include "SceneRenderTargets.h"
 #include "RHIResources.h"
+#include "RenderGraphUtils.h"
 #include "SystemTextures.h"
 #include "ScreenSpaceDenoise.h"
 #include "PostProcess/PostProcessing.h"
@@ -18,6 +20,7 @@
 #include "PipelineStateCache.h"
 #include "RayTracing/RaytracingOptions.h"
 #include "Raytracing/RaytracingLighting.h"
+#include "RayTracing/RayTracingTranslucencyHistory.h"
 
 
 static TAutoConsoleVariable<int32> CVarRayTracingTranslucency(
@@ -104,6 +107,26 @@ static FAutoConsoleVariableRef CVarRayTracingTranslucencyPrimaryRayBias(
 	GRayTracingTranslucencyPrimaryRayBias,
 	TEXT("Sets the bias to be subtracted from the primary ray TMax in ray traced Translucency. Larger bias reduces the chance of opaque objects being intersected in ray traversal, saving performance, but at the risk of skipping some thin translucent objects in proximity of opaque objects. (recommended range: 0.00001 - 0.1) (default = 0.00001)"));
 
+static TAutoConsoleVariable<int32> CVarRayTracingTranslucencyBatchViews(
+	TEXT("r.RayTracing.Translucency.BatchViews"),
+	0,
+	TEXT("How the ray traced translucency renders several views, like split screen or stereo.\n")
+	TEXT(" 0: every view traces, resolves, filters and composites its own outputs (default)\n")
+	TEXT(" 1: the views trace their own rect of shared outputs, the caustics are resolved and filtered and the translucency composited once for all of them.\n")
+	TEXT("    Only when the views tile a rectangle and all have a state, without r.RayTracing.Translucency.Checkerboard, r.RayTracing.Caustics.Early,\n")
+	TEXT("    r.RayTracing.Caustics.Denoiser 2, r.RayTracing.Caustics.ScreenPercentage below 100 or r.RayTracing.Translucency.Accumulation"),
+	ECVF_RenderThreadSafe);
+
+static int32 GRayTracingTranslucencyAccumulation = 0;
+static FAutoConsoleVariableRef CVarRayTracingTranslucencyAccumulation(
+	TEXT("r.RayTracing.Translucency.Accumulation"),
+	GRayTracingTranslucencyAccumulation,
+	TEXT("Frames the ray traced translucency and its caustics accumulate into a running mean while the view stays still, for stills and cinematics.\n")
+	TEXT("The mean starts over on camera cuts, and when the camera, the exposure, the ray tracing instances or the lights move. Once it holds this many frames\n")
+	TEXT("the view stops tracing and shows it. The caustics skip their temporal pass meanwhile, r.RayTracing.Caustics.Denoiser 1 still filters every frame.\n")
+	TEXT("Only for views with a state, and not with r.RayTracing.Caustics.Denoiser 2. (default = 0, disabled)"),
+	ECVF_RenderThreadSafe);
+
 
 DECLARE_GPU_STAT_NAMED(RayTracingTranslucency, TEXT("Ray Tracing Translucency"));
 
@@ -134,6 +157,9 @@ class FCompositeTranslucencyPS : public FGlobalShader {
 	DECLARE_GLOBAL_SHADER(FCompositeTranslucencyPS)
 	SHADER_USE_PARAMETER_STRUCT(FCompositeTranslucencyPS, FGlobalShader)
 
+	class FCausticsUpsampleDim : SHADER_PERMUTATION_BOOL("DIM_CAUSTICS_UPSAMPLE");
+	using FPermutationDomain = TShaderPermutationDomain<FCausticsUpsampleDim>;
+
 		static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
 	{
 		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
@@ -146,6 +172,12 @@ class FCompositeTranslucencyPS : public FGlobalShader {
 		SHADER_PARAMETER_SAMPLER(SamplerState, TranslucencyTextureSampler)
 		//SHADER_PARAMETER_SAMPLER(SamplerState, BaseTextureSampler)
 		SHADER_PARAMETER_SAMPLER(SamplerState, CausticsTextureSampler)
+		SHADER_PARAMETER(FIntPoint, CausticsExtent)
+		SHADER_PARAMETER(uint32, CausticsUpscaleFactor)
+		SHADER_PARAMETER(float, UpsampleNormalPower)
+		SHADER_PARAMETER(float, UpsampleDepthSigma)
+		SHADER_PARAMETER_STRUCT_INCLUDE(FSceneTextureParameters, SceneTextures)
+		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, ViewUniformBuffer)
 
 		RENDER_TARGET_BINDING_SLOTS()
 		END_SHADER_PARAMETER_STRUCT()
@@ -165,23 +197,38 @@ bool ShouldRenderRayTracingTranslucency(const FViewInfo& View)
 }
 #endif // RHI_RAYTRACING
 
+// Guides of the joint bilateral upsample of the caustics, like the caustics denoiser
+static const float CompositeCausticsUpsampleNormalPower = 64.0f;
+static const float CompositeCausticsUpsampleDepthSigma = 0.02f;
+
 void AddCompositeTexturePass(
 	FRDGBuilder& GraphBuilder,
 	const FViewInfo& View,
+	const FSceneTextureParameters& SceneTextures,
 	//FScreenPassTexture BaseInput,
 	FScreenPassTexture TranslucencyInput,
 	FScreenPassTexture AdditiveInput,
+	int32 AdditiveUpscaleFactor,
 	FScreenPassRenderTarget Output)
 {
 	const FScreenPassTextureViewport InputViewport(TranslucencyInput);
 	const FScreenPassTextureViewport OutputViewport(Output);
 
-	TShaderMapRef<FCompositeTranslucencyPS> PixelShader(View.ShaderMap);
+	// Caustics traced below full resolution are upsampled with the G-buffer of the receivers
+	FCompositeTranslucencyPS::FPermutationDomain PermutationVector;
+	PermutationVector.Set<FCompositeTranslucencyPS::FCausticsUpsampleDim>(AdditiveUpscaleFactor > 1);
+	TShaderMapRef<FCompositeTranslucencyPS> PixelShader(View.ShaderMap, PermutationVector);
 
 	FCompositeTranslucencyPS::FParameters* Parameters = GraphBuilder.AllocParameters<FCompositeTranslucencyPS::FParameters>();
 
 	Parameters->CausticsTexture = AdditiveInput.Texture;
 	Parameters->CausticsTextureSampler = TStaticSamplerState<>::GetRHI();
+	Parameters->CausticsExtent = AdditiveInput.Texture->Desc.Extent;
+	Parameters->CausticsUpscaleFactor = AdditiveUpscaleFactor;
+	Parameters->UpsampleNormalPower = CompositeCausticsUpsampleNormalPower;
+	Parameters->UpsampleDepthSigma = CompositeCausticsUpsampleDepthSigma;
+	Parameters->SceneTextures = SceneTextures;
+	Parameters->ViewUniformBuffer = View.ViewUniformBuffer;
 	//Parameters->BaseTexture = BaseInput.Texture;
 	//Parameters->BaseTextureSampler = TStaticSamplerState<>::GetRHI();
 	Parameters->TranslucencyTexture = TranslucencyInput.Texture;
@@ -191,6 +238,304 @@ void AddCompositeTexturePass(
 	AddDrawScreenPass(GraphBuilder, RDG_EVENT_NAME("CompositeTranslucent"), View, OutputViewport, InputViewport, PixelShader, Parameters);
 }
 
+extern bool UseRayTracingCausticsReflectionDenoiser();
+extern float GetRayTracingCausticsResolutionFraction();
+extern bool UseRayTracingCausticsFirstHit();
+extern bool UseRayTracingCausticsEarly();
+extern bool UseRayTracingPrimaryRaysCheckerboard();
+
+// Whether the views can share the outputs of the translucency, see r.RayTracing.Translucency.BatchViews
+static bool ShouldBatchRayTracingTranslucencyViews(const TArray<FViewInfo>& Views)
+{
+	if (CVarRayTracingTranslucencyBatchViews.GetValueOnRenderThread() == 0
+		|| Views.Num() < 2
+		|| UseRayTracingPrimaryRaysCheckerboard()
+		|| UseRayTracingCausticsEarly()
+		|| UseRayTracingCausticsReflectionDenoiser()
+		|| GetRayTracingCausticsResolutionFraction() != 1.0f
+		|| GRayTracingTranslucencyAccumulation > 0)
+	{
+		return false;
+	}
+
+	// The single composite covers the union of the views, which must not leave any pixel nobody traced
+	FIntRect UnionRect = Views[0].ViewRect;
+	int64 ViewsArea = 0;
+	for (const FViewInfo& View : Views)
+	{
+		// The temporal pass of the caustics keeps a history per view state
+		if (!View.ViewState)
+		{
+			return false;
+		}
+
+		UnionRect.Union(View.ViewRect);
+		ViewsArea += int64(View.ViewRect.Width()) * View.ViewRect.Height();
+	}
+
+	return ViewsArea == int64(UnionRect.Width()) * UnionRect.Height();
+}
+
+static int32 GetRayTracingTranslucencySamplesPerPixel(const FViewInfo& View)
+{
+	return GRayTracingTranslucencySamplesPerPixel > 1 ? GRayTracingTranslucencySamplesPerPixel : View.FinalPostProcessSettings.RayTracingTranslucencySamplesPerPixel;
+}
+
+class FRayTracingTranslucencyAccumulationCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FRayTracingTranslucencyAccumulationCS)
+	SHADER_USE_PARAMETER_STRUCT(FRayTracingTranslucencyAccumulationCS, FGlobalShader)
+
+	static const uint32 ThreadGroupSize = 8;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, ColorTexture)
+		SHADER_PARAMETER(FIntPoint, AccumulationRectMin)
+		SHADER_PARAMETER(FIntPoint, AccumulationRectMax)
+		SHADER_PARAMETER(uint32, NumAccumulatedFrames)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, AccumulationOutput)
+	END_SHADER_PARAMETER_STRUCT()
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+	}
+};
+
+IMPLEMENT_GLOBAL_SHADER(FRayTracingTranslucencyAccumulationCS, "/Engine/Private/RayTracing/RayTracingTranslucencyAccumulation.usf", "RayTracingTranslucencyAccumulationCS", SF_Compute);
+
+static const TCHAR* const TranslucencyAccumulationName = TEXT("RayTracingTranslucentAccumulation");
+static const TCHAR* const CausticsAccumulationName = TEXT("RayTracingCausticsAccumulation");
+
+// Hash of what the translucency and the caustics see besides the camera. Materials and deformed geometry are not followed, a camera cut starts the means over.
+static uint32 GetRayTracingTranslucencyAccumulationSceneHash(const FScene& Scene, const FViewInfo& View)
+{
+	uint32 Hash = FCrc::MemCrc32(&View.PreExposure, sizeof(View.PreExposure));
+
+	Hash = HashCombine(Hash, View.RayTracingGeometryInstances.Num());
+	for (const FRayTracingGeometryInstance& Instance : View.RayTracingGeometryInstances)
+	{
+		Hash = HashCombine(Hash, PointerHash(Instance.GeometryRHI));
+		for (const FMatrix& Transform : Instance.Transforms)
+		{
+			Hash = FCrc::MemCrc32(&Transform, sizeof(Transform), Hash);
+		}
+	}
+
+	Hash = HashCombine(Hash, Scene.Lights.Num());
+	for (const FLightSceneInfoCompact& Light : Scene.Lights)
+	{
+		const FMatrix& LightToWorld = Light.LightSceneInfo->Proxy->GetLightToWorld();
+		Hash = FCrc::MemCrc32(&LightToWorld, sizeof(LightToWorld), Hash);
+		Hash = FCrc::MemCrc32(&Light.Color, sizeof(Light.Color), Hash);
+	}
+
+	return Hash;
+}
+
+// Starts the means of the view over or goes on with them for this frame, returns null when the view does not accumulate.
+// Only the first call of a frame decides, the early caustics come before the translucency.
+static FRayTracingTranslucencyAccumulation* UpdateRayTracingTranslucencyAccumulation(const FScene& Scene, const FViewInfo& View)
+{
+	const uint32 FrameNumber = View.Family->FrameNumber;
+	if (GRayTracingTranslucencyAccumulation <= 0 || UseRayTracingCausticsReflectionDenoiser())
+	{
+		if (View.ViewState)
+		{
+			View.ViewState->RayTracingTranslucencyAccumulation = FRayTracingTranslucencyAccumulation();
+		}
+		return nullptr;
+	}
+
+	// A view rendered several times in a frame only accumulates its first render
+	if (!View.ViewState || View.bStatePrevViewInfoIsReadOnly)
+	{
+		return nullptr;
+	}
+
+	FRayTracingTranslucencyAccumulation& Accumulation = View.ViewState->RayTracingTranslucencyAccumulation;
+
+	if (Accumulation.LastFrameNumber != FrameNumber)
+	{
+		// The jitter of the temporal AA moves the projection every frame, the means antialias over it instead
+		const FMatrix ViewProjectionMatrix = View.ViewMatrices.GetViewMatrix() * View.ViewMatrices.GetProjectionNoAAMatrix();
+		const uint32 SceneHash = GetRayTracingTranslucencyAccumulationSceneHash(Scene, View);
+		const bool bStill = !View.bCameraCut
+			&& !View.bPrevTransformsReset
+			&& Accumulation.ViewRect == View.ViewRect
+			&& Accumulation.ViewProjectionMatrix.Equals(ViewProjectionMatrix)
+			&& Accumulation.SceneHash == SceneHash;
+
+		if (bStill)
+		{
+			Accumulation.FrameIndex++;
+		}
+		else
+		{
+			Accumulation.Targets.Empty();
+			Accumulation.FrameIndex = 0;
+		}
+
+		Accumulation.ViewProjectionMatrix = ViewProjectionMatrix;
+		Accumulation.ViewRect = View.ViewRect;
+		Accumulation.SceneHash = SceneHash;
+		Accumulation.LastFrameNumber = FrameNumber;
+	}
+
+	return &Accumulation;
+}
+
+// Means of the view this frame, once UpdateRayTracingTranslucencyAccumulation() started or went on with them
+static FRayTracingTranslucencyAccumulation* FindRayTracingTranslucencyAccumulation(const FViewInfo& View)
+{
+	if (!View.ViewState || View.bStatePrevViewInfoIsReadOnly)
+	{
+		return nullptr;
+	}
+
+	FRayTracingTranslucencyAccumulation& Accumulation = View.ViewState->RayTracingTranslucencyAccumulation;
+	return Accumulation.LastFrameNumber == View.Family->FrameNumber ? &Accumulation : nullptr;
+}
+
+// Whether the means of the view hold every frame they accumulate, the view then shows them without tracing anything
+static bool IsRayTracingTranslucencyAccumulationConverged(const FRayTracingTranslucencyAccumulation& Accumulation)
+{
+	for (const TCHAR* Name : { TranslucencyAccumulationName, CausticsAccumulationName })
+	{
+		const TUniquePtr<FRayTracingTranslucencyAccumulation::FTarget>* Target = Accumulation.Targets.Find(FName(Name));
+		if (!Target || !(*Target)->Texture.IsValid() || (*Target)->NumFrames < GRayTracingTranslucencyAccumulation)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsRayTracingTranslucencyAccumulating(const FViewInfo& View)
+{
+	return FindRayTracingTranslucencyAccumulation(View) != nullptr;
+}
+
+// Mixed into the seeds of the paths of the translucency and the caustics, 0 when the view does not accumulate
+uint32 GetRayTracingTranslucencyAccumulationFrameIndex(const FViewInfo& View)
+{
+	const FRayTracingTranslucencyAccumulation* Accumulation = FindRayTracingTranslucencyAccumulation(View);
+	return Accumulation ? Accumulation->FrameIndex : 0;
+}
+
+// Blends *InOutTexture in Rect into the mean the view keeps under Name, and replaces *InOutTexture with the mean.
+// Does nothing when the view does not accumulate.
+void AddRayTracingTranslucencyAccumulationPass(FRDGBuilder& GraphBuilder, const FViewInfo& View, FIntRect Rect, const TCHAR* Name, FRDGTextureRef* InOutTexture)
+{
+	FRayTracingTranslucencyAccumulation* Accumulation = FindRayTracingTranslucencyAccumulation(View);
+	if (!Accumulation)
+	{
+		return;
+	}
+
+	// Full float, so that the weight of the late frames is not rounded away
+	FPooledRenderTargetDesc Desc = (*InOutTexture)->Desc;
+	Desc.Format = PF_A32B32G32R32F;
+	Desc.Flags &= ~(TexCreate_FastVRAM | TexCreate_Transient);
+	Desc.TargetableFlags |= TexCreate_UAV;
+
+	TUniquePtr<FRayTracingTranslucencyAccumulation::FTarget>& TargetPtr = Accumulation->Targets.FindOrAdd(FName(Name));
+	if (!TargetPtr)
+	{
+		TargetPtr = MakeUnique<FRayTracingTranslucencyAccumulation::FTarget>();
+	}
+	FRayTracingTranslucencyAccumulation::FTarget& Target = *TargetPtr;
+
+	FRDGTextureRef AccumulationTexture = nullptr;
+	if (Target.Texture.IsValid() && Target.Texture->GetDesc().Compare(Desc, false))
+	{
+		AccumulationTexture = GraphBuilder.RegisterExternalTexture(Target.Texture, Name);
+	}
+	else
+	{
+		AccumulationTexture = GraphBuilder.CreateTexture(Desc, Name);
+		GraphBuilder.QueueTextureExtraction(AccumulationTexture, &Target.Texture);
+		Target.NumFrames = 0;
+	}
+
+	FRayTracingTranslucencyAccumulationCS::FParameters* PassParameters = GraphBuilder.AllocParameters<FRayTracingTranslucencyAccumulationCS::FParameters>();
+	PassParameters->ColorTexture = *InOutTexture;
+	PassParameters->AccumulationRectMin = Rect.Min;
+	PassParameters->AccumulationRectMax = Rect.Max;
+	PassParameters->NumAccumulatedFrames = Target.NumFrames;
+	PassParameters->AccumulationOutput = GraphBuilder.CreateUAV(AccumulationTexture);
+
+	TShaderMapRef<FRayTracingTranslucencyAccumulationCS> AccumulationShader(View.ShaderMap);
+	FComputeShaderUtils::AddPass(
+		GraphBuilder,
+		RDG_EVENT_NAME("%s(Frame=%d) %dx%d", Name, Target.NumFrames, Rect.Width(), Rect.Height()),
+		AccumulationShader,
+		PassParameters,
+		FComputeShaderUtils::GetGroupCount(Rect.Size(), FRayTracingTranslucencyAccumulationCS::ThreadGroupSize));
+
+	Target.NumFrames++;
+	*InOutTexture = AccumulationTexture;
+}
+
+void FDeferredShadingSceneRenderer::RenderRayTracingCausticsEarly(FRHICommandListImmediate& RHICmdList)
+{
+	RayTracingEarlyCaustics.Reset();
+
+	if (!UseRayTracingCausticsEarly())
+	{
+		return;
+	}
+
+	FRDGBuilder GraphBuilder(RHICmdList);
+	RayTracingEarlyCaustics.SetNum(Views.Num());
+
+	{
+		RDG_EVENT_SCOPE(GraphBuilder, "RayTracingCausticsEarly");
+		RDG_GPU_STAT_SCOPE(GraphBuilder, RayTracingTranslucency)
+
+		for (int32 ViewIndex = 0, Num = Views.Num(); ViewIndex < Num; ViewIndex++)
+		{
+			FViewInfo& View = Views[ViewIndex];
+			if (!ShouldRenderRayTracingTranslucency(View))
+			{
+				continue;
+			}
+
+			// The translucency shows the means of the view as they are
+			const FRayTracingTranslucencyAccumulation* Accumulation = UpdateRayTracingTranslucencyAccumulation(*Scene, View);
+			if (Accumulation && IsRayTracingTranslucencyAccumulationConverged(*Accumulation))
+			{
+				continue;
+			}
+
+			FRDGTextureRef CausticsColor = nullptr;
+			FRDGTextureRef CausticsRayHitDistance = nullptr;
+			FRDGTextureRef CausticsRayImaginaryDepth = nullptr;
+
+			RenderRayTracingCaustics(
+				GraphBuilder,
+				View,
+				&CausticsColor, &CausticsRayHitDistance, &CausticsRayImaginaryDepth,
+				nullptr,
+				GetRayTracingTranslucencySamplesPerPixel(View), GRayTracingTranslucencyHeightFog, GetRayTracingCausticsResolutionFraction()
+			);
+
+			FRayTracingEarlyCaustics& EarlyCaustics = RayTracingEarlyCaustics[ViewIndex];
+			GraphBuilder.QueueTextureExtraction(CausticsColor, &EarlyCaustics.Color);
+			GraphBuilder.QueueTextureExtraction(CausticsRayHitDistance, &EarlyCaustics.RayHitDistance);
+			GraphBuilder.QueueTextureExtraction(CausticsRayImaginaryDepth, &EarlyCaustics.RayImaginaryDepth);
+		}
+	}
+
+	GraphBuilder.Execute();
+}
+
 void FDeferredShadingSceneRenderer::RenderRayTracingTranslucency(FRHICommandListImmediate& RHICmdList)
 {
 	if (!ShouldRenderTranslucency(ETranslucencyPass::TPT_StandardTranslucency)
@@ -215,6 +560,13 @@ void FDeferredShadingSceneRenderer::RenderRayTracingTranslucency(FRHICommandList
 		RDG_EVENT_SCOPE(GraphBuilder, "RayTracingTranslucency");
 		RDG_GPU_STAT_SCOPE(GraphBuilder, RayTracingTranslucency)
 
+			// Batched views trace their own rect of the same outputs, which are composited once after the last view
+			const bool bBatchViews = ShouldBatchRayTracingTranslucencyViews(Views);
+			IScreenSpaceDenoiser::FReflectionsInputs BatchDenoiserInputs;
+			IScreenSpaceDenoiser::FReflectionsInputs BatchCausticsInputs;
+			FRayTracingCausticsBatch CausticsBatch;
+			FIntRect BatchViewRect = Views[0].ViewRect;
+
 			for (int32 ViewIndex = 0, Num = Views.Num(); ViewIndex < Num; ViewIndex++)
 			{
 				FViewInfo& View = Views[ViewIndex];
@@ -223,34 +575,76 @@ void FDeferredShadingSceneRenderer::RenderRayTracingTranslucency(FRHICommandList
 
 				//#dxr_todo: UE-72581 do not use reflections denoiser structs but separated ones
 				IScreenSpaceDenoiser::FReflectionsRayTracingConfig RayTracingConfig;
-				IScreenSpaceDenoiser::FReflectionsInputs DenoiserInputs;
-				IScreenSpaceDenoiser::FReflectionsInputs CausticsInputs;
+				IScreenSpaceDenoiser::FReflectionsInputs ViewDenoiserInputs;
+				IScreenSpaceDenoiser::FReflectionsInputs ViewCausticsInputs;
+				IScreenSpaceDenoiser::FReflectionsInputs& DenoiserInputs = bBatchViews ? BatchDenoiserInputs : ViewDenoiserInputs;
+				IScreenSpaceDenoiser::FReflectionsInputs& CausticsInputs = bBatchViews ? BatchCausticsInputs : ViewCausticsInputs;
 				FRDGTextureRef PrimaryRayColorTexture = nullptr;
 
 				float ResolutionFraction = 1.0f;
-				int32 TranslucencySPP = GRayTracingTranslucencySamplesPerPixel > 1 ? GRayTracingTranslucencySamplesPerPixel : View.FinalPostProcessSettings.RayTracingTranslucencySamplesPerPixel;
+				int32 TranslucencySPP = GetRayTracingTranslucencySamplesPerPixel(View);
 
 				RayTracingConfig.RayCountPerPixel = TranslucencySPP;
 				RayTracingConfig.ResolutionFraction = ResolutionFraction;
 
-				RenderRayTracingPrimaryRaysView(
-					GraphBuilder,
-					View, &DenoiserInputs.Color, &DenoiserInputs.RayHitDistance, &DenoiserInputs.RayImaginaryDepth,
-					&CausticsInputs.Color,
-					TranslucencySPP, GRayTracingTranslucencyHeightFog, ResolutionFraction,
-					ERayTracingPrimaryRaysFlag::AllowSkipSkySample | ERayTracingPrimaryRaysFlag::UseGBufferForMaxDistance);
+				// The caustics start from the same camera rays, the translucency hands over their first hits when it can
+				FRDGTextureRef FirstHitTexture = nullptr;
+
+				// Batched views never accumulate, see ShouldBatchRayTracingTranslucencyViews()
+				const FRayTracingTranslucencyAccumulation* Accumulation = UpdateRayTracingTranslucencyAccumulation(*Scene, View);
+				const bool bAccumulationConverged = Accumulation && IsRayTracingTranslucencyAccumulationConverged(*Accumulation);
+				if (bAccumulationConverged)
+				{
+					// Every frame the view accumulates is in the means, nothing is traced until the view moves
+					DenoiserInputs.Color = GraphBuilder.RegisterExternalTexture(Accumulation->Targets.FindChecked(TranslucencyAccumulationName)->Texture, TranslucencyAccumulationName);
+					CausticsInputs.Color = GraphBuilder.RegisterExternalTexture(Accumulation->Targets.FindChecked(CausticsAccumulationName)->Texture, CausticsAccumulationName);
+				}
+				else
+				{
+					RenderRayTracingPrimaryRaysView(
+						GraphBuilder,
+						View, &DenoiserInputs.Color, &DenoiserInputs.RayHitDistance, &DenoiserInputs.RayImaginaryDepth,
+						&CausticsInputs.Color,
+						TranslucencySPP, GRayTracingTranslucencyHeightFog, ResolutionFraction,
+						ERayTracingPrimaryRaysFlag::AllowSkipSkySample | ERayTracingPrimaryRaysFlag::UseGBufferForMaxDistance,
+						UseRayTracingCausticsFirstHit() ? &FirstHitTexture : nullptr);
+
+					AddRayTracingTranslucencyAccumulationPass(GraphBuilder, View, View.ViewRect, TranslucencyAccumulationName, &DenoiserInputs.Color);
+				}
 
 				const IScreenSpaceDenoiser* DefaultDenoiser = IScreenSpaceDenoiser::GetDefaultDenoiser();
 				const IScreenSpaceDenoiser* DenoiserToUse = DefaultDenoiser;
 
 				ResolveSceneColor(RHICmdList);
 
-				RenderRayTracingCaustics(
-					GraphBuilder,
-					View,
-					&CausticsInputs.Color, &CausticsInputs.RayHitDistance, &CausticsInputs.RayImaginaryDepth,
-					TranslucencySPP, GRayTracingTranslucencyHeightFog, ResolutionFraction
-				);
+				// The caustics have their own resolution, RenderRayTracingCaustics gives them their own color texture below full resolution
+				const float CausticsResolutionFraction = GetRayTracingCausticsResolutionFraction();
+				int32 CausticsUpscaleFactor = int32(1.0f / CausticsResolutionFraction);
+
+				const FRayTracingEarlyCaustics* EarlyCaustics = RayTracingEarlyCaustics.IsValidIndex(ViewIndex) && RayTracingEarlyCaustics[ViewIndex].Color.IsValid() ? &RayTracingEarlyCaustics[ViewIndex] : nullptr;
+				if (EarlyCaustics)
+				{
+					CausticsInputs.Color = GraphBuilder.RegisterExternalTexture(EarlyCaustics->Color);
+					CausticsInputs.RayHitDistance = GraphBuilder.RegisterExternalTexture(EarlyCaustics->RayHitDistance);
+					CausticsInputs.RayImaginaryDepth = GraphBuilder.RegisterExternalTexture(EarlyCaustics->RayImaginaryDepth);
+				}
+				else if (!bAccumulationConverged)
+				{
+					RenderRayTracingCaustics(
+						GraphBuilder,
+						View,
+						&CausticsInputs.Color, &CausticsInputs.RayHitDistance, &CausticsInputs.RayImaginaryDepth,
+						FirstHitTexture,
+						TranslucencySPP, GRayTracingTranslucencyHeightFog, CausticsResolutionFraction,
+						bBatchViews ? &CausticsBatch : nullptr
+					);
+				}
+
+				if (bBatchViews)
+				{
+					BatchViewRect.Union(View.ViewRect);
+					continue;
+				}
 
 
 				RDG_EVENT_SCOPE(GraphBuilder, "%s%s(Transluency) %dx%d",
@@ -266,25 +660,51 @@ void FDeferredShadingSceneRenderer::RenderRayTracingTranslucency(FRHICommandList
 					DenoiserInputs,
 					RayTracingConfig);*/
 
-				IScreenSpaceDenoiser::FReflectionsOutputs CausticsDenoiserOutputs = DenoiserToUse->DenoiseReflections(
-					GraphBuilder,
-					View,
-					&View.PrevViewInfo,
-					SceneTextures,
-					CausticsInputs,
-					RayTracingConfig);
-
-				const FScreenPassTexture AdditiveColor(CausticsDenoiserOutputs.Color, View.ViewRect);
+				// RenderRayTracingCaustics denoises the caustics itself unless the reflections denoiser is asked for
+				FRDGTextureRef CausticsColor = CausticsInputs.Color;
+				if (UseRayTracingCausticsReflectionDenoiser())
+				{
+					// The reflections denoiser upscales to full resolution itself
+					IScreenSpaceDenoiser::FReflectionsRayTracingConfig CausticsRayTracingConfig = RayTracingConfig;
+					CausticsRayTracingConfig.ResolutionFraction = CausticsResolutionFraction;
+
+					IScreenSpaceDenoiser::FReflectionsOutputs CausticsDenoiserOutputs = DenoiserToUse->DenoiseReflections(
+						GraphBuilder,
+						View,
+						&View.PrevViewInfo,
+						SceneTextures,
+						CausticsInputs,
+						CausticsRayTracingConfig);
+					CausticsColor = CausticsDenoiserOutputs.Color;
+					CausticsUpscaleFactor = 1;
+				}
+
+				const FScreenPassTexture AdditiveColor(CausticsColor, View.ViewRect);
 				const FScreenPassTexture Transparency(DenoiserInputs.Color, View.ViewRect);
 				//const FScreenPassTexture BaseColor(PrimaryRayColorTexture, View.ViewRect);
 
-				AddCompositeTexturePass(GraphBuilder, View, Transparency, AdditiveColor, Output);
+				AddCompositeTexturePass(GraphBuilder, View, SceneTextures, Transparency, AdditiveColor, CausticsUpscaleFactor, Output);
 				//AddDrawTexturePass(GraphBuilder, View, AdditiveColor, Output);
 			}
+
+			if (bBatchViews)
+			{
+				FinishRayTracingCausticsBatch(GraphBuilder, CausticsBatch, &BatchCausticsInputs.Color);
+
+				// The caustics are at full resolution when batched, one composite covers every view
+				const FScreenPassRenderTarget Output(SceneColorTexture, BatchViewRect, ERenderTargetLoadAction::ELoad);
+				const FScreenPassTexture AdditiveColor(BatchCausticsInputs.Color, BatchViewRect);
+				const FScreenPassTexture Transparency(BatchDenoiserInputs.Color, BatchViewRect);
+
+				AddCompositeTexturePass(GraphBuilder, Views[0], SceneTextures, Transparency, AdditiveColor, 1, Output);
+			}
 	}
 
 	GraphBuilder.Execute();
 
+	// The early caustics are only good for this frame
+	RayTracingEarlyCaustics.Reset();
+
 	ResolveSceneColor(RHICmdList);
 }
 
@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "RendererInterface.h"
+
+#if RHI_RAYTRACING
+
+/**
+ * Histories of the ray traced translucency and caustics, held by the view state like the other histories of the renderer.
+ * The temporal ones are members of FPreviousViewInfo: they are read from View.PrevViewInfo and written to
+ * View.ViewState->PrevFrameViewInfo unless View.bStatePrevViewInfoIsReadOnly, and are released with the view state.
+ * The running means of a still view are updated in place, FSceneViewState holds them directly.
+ */
+
+/** Targets the caustics write in place every frame rather than take from the pool, see CreateRayTracingCausticsPersistentTexture(). */
+namespace ERayTracingCausticsPersistentTexture
+{
+	enum Type
+	{
+		TranslucencyColor,
+		ProgressiveColor,
+		HitDistance,
+		ImaginaryDepth,
+		Num
+	};
+}
+
+/** Temporal history of the screen space caustics, FPreviousViewInfo::RayTracingCausticsHistory. */
+struct FRayTracingCausticsHistory
+{
+	TRefCountPtr<IPooledRenderTarget> Color;
+	TRefCountPtr<IPooledRenderTarget> Metadata;
+
+	/** Read by the adaptive sampling of the next frame. */
+	TRefCountPtr<IPooledRenderTarget> Variance;
+
+	TRefCountPtr<IPooledRenderTarget> PersistentTextures[ERayTracingCausticsPersistentTexture::Num];
+
+	/** First tile the next frame traces, see r.RayTracing.Caustics.ProgressiveTilesPerFrame. */
+	int32 ProgressiveTileIndex = 0;
+};
+
+/** Reconstructed translucency of the previous frame, the history of r.RayTracing.Translucency.Checkerboard, FPreviousViewInfo::RayTracingPrimaryRaysCheckerboardHistory. */
+struct FRayTracingPrimaryRaysCheckerboardHistory
+{
+	TRefCountPtr<IPooledRenderTarget> Color;
+};
+
+/** Running means of the translucency and the caustics of a still view, see r.RayTracing.Translucency.Accumulation. FSceneViewState::RayTracingTranslucencyAccumulation. */
+struct FRayTracingTranslucencyAccumulation
+{
+	struct FTarget
+	{
+		TRefCountPtr<IPooledRenderTarget> Texture;
+		int32 NumFrames = 0;
+	};
+
+	/** Means by debug name, held by pointer since the graph extracts into them after the map may have grown. */
+	TMap<FName, TUniquePtr<FTarget>> Targets;
+
+	/** What the means were accumulated from, any change starts them over. */
+	FMatrix ViewProjectionMatrix = FMatrix::Identity;
+	FIntRect ViewRect;
+	uint32 SceneHash = 0;
+
+	/** Frames since the means started over, moves the seeds of the paths on even when the world is paused. */
+	uint32 FrameIndex = 0;
+
+	/** Frame the means were last updated in, only the first render of a frame updates them. */
+	uint32 LastFrameNumber = 0;
+};
+
+#endif // RHI_RAYTRACING